@@ -0,0 +1,389 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Micro benchmarks of the code which runs for every mouse event a frameless
+// window gets. Besides the usual QBENCHMARK output every case reports the
+// time and the number of heap allocations per event (or per call), which are
+// written to the JSON file given by $FRAMELESSHELPER_BENCHMARK_JSON as well
+// ("hotpath.json" in the current directory by default).
+//
+// Run it with QT_QPA_PLATFORM=offscreen, or through the run_hotpath_benchmarks target.
+
+#include <QtTest/qtest.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qwindow.h>
+#include <QtWidgets/qwidget.h>
+#include "../../tests/shared/allocationcounter.h"
+#include "../../framelesswindowsmanager.h"
+#include "../../utilities.h"
+#include <iterator>
+#include <memory>
+#include <vector>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+static constexpr int kWindowWidth = 800;
+static constexpr int kWindowHeight = 600;
+static constexpr int kStreamLength = 256;
+
+// Installed before the frameless helper, so it sees the mouse events right
+// after the helper and keeps them away from the widgets: only the cost of
+// the helper is measured.
+class MouseEventSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MouseEventSink(QObject *parent = nullptr) : QObject(parent) {}
+
+    bool eventFilter(QObject *object, QEvent *event) override
+    {
+        Q_UNUSED(object);
+        switch (event->type()) {
+        case QEvent::MouseMove:
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+// Accumulates the time and the allocations of the measured blocks only.
+class Measurement
+{
+public:
+    Measurement()
+    {
+        AllocationCounter::reset();
+    }
+
+    template<typename Functor>
+    void run(const int operations, Functor &&functor)
+    {
+        QElapsedTimer timer;
+        AllocationCounter::resume();
+        timer.start();
+        functor();
+        m_elapsed += timer.nsecsElapsed();
+        AllocationCounter::pause();
+        m_operations += quint64(operations);
+    }
+
+    [[nodiscard]] QJsonObject result() const
+    {
+        const double operations = double(qMax(m_operations, quint64(1)));
+        const double nsPerOperation = (double(m_elapsed) / operations);
+        const double allocationsPerOperation = (double(AllocationCounter::count()) / operations);
+        qInfo("%s: %.1f ns and %.3f allocations per event", QTest::currentDataTag(),
+              nsPerOperation, allocationsPerOperation);
+        QJsonObject object = {};
+        object.insert(QStringLiteral("name"), QString::fromUtf8(QTest::currentTestFunction()));
+        object.insert(QStringLiteral("tag"), QString::fromUtf8(QTest::currentDataTag()));
+        object.insert(QStringLiteral("events"), double(m_operations));
+        object.insert(QStringLiteral("nsPerEvent"), nsPerOperation);
+        object.insert(QStringLiteral("allocationsPerEvent"), allocationsPerOperation);
+        return object;
+    }
+
+private:
+    qint64 m_elapsed = 0;
+    quint64 m_operations = 0;
+};
+
+[[nodiscard]] static std::unique_ptr<QMouseEvent> mouseMove(const QWindow *window, const QPoint &pos)
+{
+    return std::make_unique<QMouseEvent>(QEvent::MouseMove, pos, pos, window->mapToGlobal(pos),
+                                         Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+}
+
+// Hovers over the contents, the title bar (on and between the hit test visible
+// controls) and the resize edges, so every branch of the event filter is taken.
+[[nodiscard]] static std::vector<QPoint> hoverPath()
+{
+    const QPoint points[] = {
+        {kWindowWidth / 2, kWindowHeight / 2}, {100, 15}, {300, 10}, {500, 15}, {700, 12},
+        {2, kWindowHeight / 2}, {kWindowWidth - 2, kWindowHeight / 2}, {kWindowWidth / 2, kWindowHeight - 2},
+        {kWindowWidth - 2, kWindowHeight - 2}, {2, 2}, {kWindowWidth / 3, kWindowHeight / 3}
+    };
+    std::vector<QPoint> path = {};
+    path.reserve(kStreamLength);
+    for (int i = 0; i != kStreamLength; ++i) {
+        path.push_back(points[i % std::size(points)]);
+    }
+    return path;
+}
+
+class FramelessWidget
+{
+public:
+    explicit FramelessWidget(const int hitTestObjectCount)
+    {
+        m_widget.resize(kWindowWidth, kWindowHeight);
+        m_widget.createWinId();
+        QWindow * const window = m_widget.windowHandle();
+        window->installEventFilter(&m_sink);
+        FramelessWindowsManager::addWindow(window);
+        // Small controls packed into the title bar, like toolbar buttons.
+        for (int i = 0; i != hitTestObjectCount; ++i) {
+            const auto control = new QWidget(&m_widget);
+            control->setGeometry(200 + ((i * 5) % 400), 4 + ((i / 80) % 3) * 6, 8, 8);
+            FramelessWindowsManager::setHitTestVisible(window, control, true);
+        }
+        m_widget.show();
+    }
+
+    [[nodiscard]] QWindow *window() const
+    {
+        return m_widget.windowHandle();
+    }
+
+    [[nodiscard]] bool isExposed()
+    {
+        return QTest::qWaitForWindowExposed(&m_widget);
+    }
+
+private:
+    MouseEventSink m_sink;
+    QWidget m_widget;
+};
+
+class tst_HotPath : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void cleanupTestCase();
+
+    void eventFilter_data();
+    void eventFilter();
+    void isHitTestVisible_data();
+    void isHitTestVisible();
+    void getSystemMetric_data();
+    void getSystemMetric();
+    void findWindow_data();
+    void findWindow();
+    void calculateResizeGeometry_data();
+    void calculateResizeGeometry();
+
+private:
+    QJsonArray m_results = {};
+};
+
+void tst_HotPath::cleanupTestCase()
+{
+    QString filePath = QString::fromLocal8Bit(qgetenv("FRAMELESSHELPER_BENCHMARK_JSON"));
+    if (filePath.isEmpty()) {
+        filePath = QStringLiteral("hotpath.json");
+    }
+    QJsonObject root = {};
+    root.insert(QStringLiteral("benchmark"), QStringLiteral("hotpath"));
+    root.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    root.insert(QStringLiteral("platform"), QGuiApplication::platformName());
+    root.insert(QStringLiteral("results"), m_results);
+    QFile file(filePath);
+    QVERIFY2(file.open(QFile::WriteOnly | QFile::Truncate), qPrintable(file.errorString()));
+    file.write(QJsonDocument(root).toJson());
+}
+
+static void addObjectCountRows()
+{
+    QTest::addColumn<int>("objectCount");
+    QTest::newRow("0 objects") << 0;
+    QTest::newRow("10 objects") << 10;
+    QTest::newRow("100 objects") << 100;
+    QTest::newRow("1000 objects") << 1000;
+}
+
+void tst_HotPath::eventFilter_data()
+{
+    addObjectCountRows();
+}
+
+void tst_HotPath::eventFilter()
+{
+    QFETCH(int, objectCount);
+    FramelessWidget widget(objectCount);
+    QVERIFY(widget.isExposed());
+    QWindow * const window = widget.window();
+    std::vector<std::unique_ptr<QMouseEvent>> events = {};
+    for (auto &&pos : hoverPath()) {
+        events.push_back(mouseMove(window, pos));
+    }
+    const auto sendEvents = [window, &events](){
+        for (auto &&event : events) {
+            QCoreApplication::sendEvent(window, event.get());
+        }
+    };
+    // Fill the caches first, the steady state is what matters.
+    sendEvents();
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.run(int(events.size()), sendEvents);
+    }
+    m_results.append(measurement.result());
+}
+
+void tst_HotPath::isHitTestVisible_data()
+{
+    addObjectCountRows();
+}
+
+void tst_HotPath::isHitTestVisible()
+{
+    QFETCH(int, objectCount);
+    FramelessWidget widget(objectCount);
+    QVERIFY(widget.isExposed());
+    const QWindow * const window = widget.window();
+    std::vector<QPointF> globalPositions = {};
+    for (auto &&pos : hoverPath()) {
+        globalPositions.push_back(window->mapToGlobal(pos));
+    }
+    int visibleCount = 0;
+    const auto hitTest = [window, &globalPositions, &visibleCount](){
+        for (auto &&pos : globalPositions) {
+            if (Utilities::isHitTestVisible(window, pos)) {
+                ++visibleCount;
+            }
+        }
+    };
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.run(int(globalPositions.size()), hitTest);
+    }
+    QVERIFY((objectCount == 0) || (visibleCount > 0));
+    m_results.append(measurement.result());
+}
+
+void tst_HotPath::getSystemMetric_data()
+{
+    QTest::addColumn<SystemMetric>("metric");
+    QTest::newRow("ResizeBorderThickness") << SystemMetric::ResizeBorderThickness;
+    QTest::newRow("CaptionHeight") << SystemMetric::CaptionHeight;
+    QTest::newRow("TitleBarHeight") << SystemMetric::TitleBarHeight;
+}
+
+void tst_HotPath::getSystemMetric()
+{
+    QFETCH(SystemMetric, metric);
+    FramelessWidget widget(0);
+    QVERIFY(widget.isExposed());
+    const QWindow * const window = widget.window();
+    int sum = 0;
+    const auto query = [window, metric, &sum](){
+        for (int i = 0; i != kStreamLength; ++i) {
+            sum += Utilities::getSystemMetric(window, metric, true);
+        }
+    };
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.run(kStreamLength, query);
+    }
+    QVERIFY(sum > 0);
+    m_results.append(measurement.result());
+}
+
+void tst_HotPath::findWindow_data()
+{
+    QTest::addColumn<int>("windowCount");
+    QTest::newRow("1 window") << 1;
+    QTest::newRow("10 windows") << 10;
+    QTest::newRow("100 windows") << 100;
+}
+
+void tst_HotPath::findWindow()
+{
+    QFETCH(int, windowCount);
+    std::vector<std::unique_ptr<QWindow>> windows = {};
+    for (int i = 0; i != windowCount; ++i) {
+        auto window = std::make_unique<QWindow>();
+        window->create();
+        windows.push_back(std::move(window));
+    }
+    // The worst case: the window created last.
+    const WId winId = windows.back()->winId();
+    int found = 0;
+    const auto lookUp = [winId, &found](){
+        for (int i = 0; i != kStreamLength; ++i) {
+            if (Utilities::findWindow(winId)) {
+                ++found;
+            }
+        }
+    };
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.run(kStreamLength, lookUp);
+    }
+    QVERIFY(found > 0);
+    m_results.append(measurement.result());
+}
+
+void tst_HotPath::calculateResizeGeometry_data()
+{
+    QTest::addColumn<bool>("constrained");
+    QTest::newRow("no constraints") << false;
+    QTest::newRow("all constraints") << true;
+}
+
+// The solver runs for every mouse move of a resize.
+void tst_HotPath::calculateResizeGeometry()
+{
+    QFETCH(bool, constrained);
+    GeometryConstraints constraints = {};
+    constraints.minimumSize = {200, 150};
+    if (constrained) {
+        constraints.maximumSize = {1600, 1200};
+        constraints.sizeIncrement = {8, 16};
+        constraints.baseSize = {100, 50};
+        constraints.aspectRatio = (16.0 / 9.0);
+        constraints.workArea = {0, 0, 1920, 1040};
+    }
+    const QRect original = {100, 100, kWindowWidth, kWindowHeight};
+    const Qt::Edges edges[] = {Qt::RightEdge, Qt::BottomEdge, (Qt::BottomEdge | Qt::RightEdge), (Qt::TopEdge | Qt::LeftEdge)};
+    int sum = 0;
+    const auto solve = [&original, &edges, &constraints, &sum](){
+        for (int i = 0; i != kStreamLength; ++i) {
+            const QPoint delta = {((i * 7) % 400) - 200, ((i * 5) % 300) - 150};
+            sum += Utilities::calculateResizeGeometry(original, edges[i % std::size(edges)], delta, constraints).width();
+        }
+    };
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.run(kStreamLength, solve);
+    }
+    QVERIFY(sum > 0);
+    m_results.append(measurement.result());
+}
+
+QTEST_MAIN(tst_HotPath)
+
+#include "tst_hotpath.moc"
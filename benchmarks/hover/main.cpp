@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Startup time and latency of the first hover over a resize edge of a frameless
+// window, with and without pre-warming the resize cursors when the window is created.
+//
+// "first hover" is how long the first mouse move onto the bottom right corner
+// takes to be handled (that's where the cursor is changed for the first time),
+// "warm hover" is the same move once the cursor has been used already. Every
+// sample is a new process because the cursors are cached for the lifetime of
+// the process. The modes are interleaved.
+//
+// Usage: HoverBenchmark [--runs N]
+// Run it under X11 (or Xvfb), loading the cursor theme is what's being
+// measured. The offscreen platform has no cursors at all.
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qrasterwindow.h>
+#include "../../framelesswindowsmanager.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+static constexpr char kChildArgument[] = "--child";
+static constexpr char kPrewarmMode[] = "prewarm";
+static constexpr char kLazyMode[] = "lazy";
+
+// How long to let the application settle after the first frame, the
+// cursors are pre-warmed once the event loop is running.
+static constexpr int kSettleTime = 200;
+
+[[nodiscard]] static qint64 hover(QWindow *window, const QPoint &pos)
+{
+    Q_ASSERT(window);
+    QMouseEvent event(QEvent::MouseMove, pos, pos, window->mapToGlobal(pos), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+    QElapsedTimer timer;
+    timer.start();
+    QCoreApplication::sendEvent(window, &event);
+    return timer.nsecsElapsed();
+}
+
+class HoverWindow : public QRasterWindow
+{
+public:
+    explicit HoverWindow(const QElapsedTimer *timer) : m_timer(timer) {}
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        Q_UNUSED(event);
+        QPainter painter(this);
+        painter.fillRect(QRect(QPoint(0, 0), size()), Qt::white);
+        painter.end();
+        if (m_startupTime >= 0) {
+            return;
+        }
+        m_startupTime = m_timer->nsecsElapsed();
+        QTimer::singleShot(kSettleTime, this, [this](){
+            const QPoint center(width() / 2, height() / 2);
+            const QPoint corner(width() - 2, height() - 2);
+            Q_UNUSED(hover(this, center));
+            const qint64 firstHover = hover(this, corner);
+            Q_UNUSED(hover(this, center));
+            const qint64 warmHover = hover(this, corner);
+            std::printf("%lld %lld %lld\n", static_cast<long long>(m_startupTime),
+                        static_cast<long long>(firstHover), static_cast<long long>(warmHover));
+            std::fflush(stdout);
+            QCoreApplication::quit();
+        });
+    }
+
+private:
+    const QElapsedTimer *m_timer = nullptr;
+    qint64 m_startupTime = -1;
+};
+
+static int runChild(const QElapsedTimer &timer, int argc, char *argv[], const bool prewarm)
+{
+    QGuiApplication application(argc, argv);
+    FramelessWindowsManager::setCursorPrewarmingEnabled(prewarm);
+    HoverWindow window(&timer);
+    window.resize(800, 600);
+    FramelessWindowsManager::addWindow(&window);
+    window.show();
+    return QGuiApplication::exec();
+}
+
+struct Sample
+{
+    qint64 startup = 0;
+    qint64 firstHover = 0;
+    qint64 warmHover = 0;
+};
+
+[[nodiscard]] static bool runSample(const QString &program, const char *mode, Sample *sample)
+{
+    Q_ASSERT(sample);
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process.start(program, {QString::fromLatin1(kChildArgument), QString::fromLatin1(mode)});
+    if (!process.waitForFinished() || (process.exitCode() != 0)) {
+        return false;
+    }
+    const QList<QByteArray> values = process.readAllStandardOutput().simplified().split(' ');
+    if (values.size() != 3) {
+        return false;
+    }
+    sample->startup = values.at(0).toLongLong();
+    sample->firstHover = values.at(1).toLongLong();
+    sample->warmHover = values.at(2).toLongLong();
+    return true;
+}
+
+static void printResult(const char *name, std::vector<qint64> samples, const double divisor, const char *unit)
+{
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples, divisor](const double p) -> double {
+        const auto index = static_cast<std::size_t>(p * double(samples.size() - 1) + 0.5);
+        return (double(samples.at(index)) / divisor);
+    };
+    std::printf("  %-12s min %9.2f %s  median %9.2f %s  p90 %9.2f %s\n", name,
+                percentile(0.0), unit, percentile(0.5), unit, percentile(0.9), unit);
+}
+
+static void printResults(const char *mode, const std::vector<Sample> &samples)
+{
+    std::vector<qint64> startup = {}, firstHover = {}, warmHover = {};
+    for (auto &&sample : samples) {
+        startup.push_back(sample.startup);
+        firstHover.push_back(sample.firstHover);
+        warmHover.push_back(sample.warmHover);
+    }
+    std::printf("%s (%zu runs):\n", mode, samples.size());
+    printResult("startup", startup, 1000000.0, "ms");
+    printResult("first hover", firstHover, 1000.0, "us");
+    printResult("warm hover", warmHover, 1000.0, "us");
+}
+
+int main(int argc, char *argv[])
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if ((argc == 3) && (std::strcmp(argv[1], kChildArgument) == 0)) {
+        return runChild(timer, argc, argv, (std::strcmp(argv[2], kPrewarmMode) == 0));
+    }
+
+    int runs = 20;
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--runs") == 0) && ((i + 1) < argc)) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    QCoreApplication application(argc, argv);
+    const QString program = QCoreApplication::applicationFilePath();
+
+    std::vector<Sample> prewarm = {};
+    std::vector<Sample> lazy = {};
+    for (int i = 0; i != runs; ++i) {
+        Sample prewarmSample = {};
+        Sample lazySample = {};
+        if (!runSample(program, kPrewarmMode, &prewarmSample) || !runSample(program, kLazyMode, &lazySample)) {
+            std::fprintf(stderr, "Run %d failed.\n", i);
+            return -1;
+        }
+        prewarm.push_back(prewarmSample);
+        lazy.push_back(lazySample);
+    }
+
+    printResults(kPrewarmMode, prewarm);
+    printResults(kLazyMode, lazy);
+    return 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// End-to-end latency of dragging and resizing the windows of the widget and
+// the Qt Quick examples: how long it takes from a pointer motion until the
+// window has moved (drags), or has been resized and repainted (resizes).
+// The pointer is driven through QTest, i.e. through the same window system
+// interface the real input goes through. Besides the per-step latency
+// percentiles the intervals between the frames painted during the interaction
+// are reported, and everything is written to the JSON file given by
+// $FRAMELESSHELPER_BENCHMARK_JSON ("interactive.json" by default).
+//
+// Usage: InteractiveBenchmark [--steps N]
+// Runs under Xvfb (without a window manager) or QT_QPA_PLATFORM=offscreen,
+// Qt Quick needs QT_QUICK_BACKEND=software with the latter. The
+// run_interactive_benchmark target does all of that.
+
+#include <QtTest/qtest.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qmutex.h>
+#include <QtWidgets/qapplication.h>
+#include "../../examples/widget/widget.h"
+#ifdef BENCHMARK_HAS_QUICK
+#include <QtQml/qqmlapplicationengine.h>
+#include <QtQuick/qquickwindow.h>
+#include <QtQuickControls2/qquickstyle.h>
+#include "../../framelessquickhelper.h"
+#include "../../examples/quick/utilfunctions.h"
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+static constexpr int kStepTimeout = 1000;
+
+// Keeps the windows well inside the default 800x600 screen of the offscreen
+// platform for the whole run.
+static const QRect kInitialGeometry = {50, 50, 400, 300};
+static const QPoint kStepDelta = {2, 1};
+
+static QElapsedTimer g_clock;
+
+// Timestamps of the frames and of the geometry changes of a window.
+class WindowClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowClock(QWindow *window, QObject *parent = nullptr) : QObject(parent)
+    {
+        window->installEventFilter(this);
+    }
+
+    void recordFrame()
+    {
+        // Qt Quick may render on its own thread.
+        const QMutexLocker locker(&m_mutex);
+        m_frames.push_back(g_clock.nsecsElapsed());
+    }
+
+    [[nodiscard]] std::vector<qint64> frames() const
+    {
+        const QMutexLocker locker(&m_mutex);
+        return m_frames;
+    }
+
+    [[nodiscard]] std::vector<qint64> geometryChanges() const
+    {
+        return m_geometryChanges;
+    }
+
+    bool eventFilter(QObject *object, QEvent *event) override
+    {
+        if ((event->type() == QEvent::Move) || (event->type() == QEvent::Resize)) {
+            m_geometryChanges.push_back(g_clock.nsecsElapsed());
+        }
+        return QObject::eventFilter(object, event);
+    }
+
+private:
+    mutable QMutex m_mutex;
+    std::vector<qint64> m_frames = {};
+    std::vector<qint64> m_geometryChanges = {};
+};
+
+// The widget example, with every paint of the window recorded as a frame.
+class BenchmarkWidget : public Widget
+{
+    Q_OBJECT
+
+public:
+    explicit BenchmarkWidget(QWidget *parent = nullptr) : Widget(parent) {}
+
+    void setClock(WindowClock *clock)
+    {
+        m_clock = clock;
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        Widget::paintEvent(event);
+        if (m_clock) {
+            m_clock->recordFrame();
+        }
+    }
+
+private:
+    WindowClock *m_clock = nullptr;
+};
+
+[[nodiscard]] static qint64 firstAfter(const std::vector<qint64> &timestamps, const qint64 since)
+{
+    const auto it = std::upper_bound(timestamps.cbegin(), timestamps.cend(), since);
+    return ((it == timestamps.cend()) ? -1 : *it);
+}
+
+[[nodiscard]] static QJsonObject percentiles(std::vector<qint64> samples)
+{
+    QJsonObject object = {};
+    object.insert(QStringLiteral("count"), int(samples.size()));
+    if (samples.empty()) {
+        return object;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](const double p) -> double {
+        const auto index = static_cast<std::size_t>(p * double(samples.size() - 1) + 0.5);
+        return (double(samples.at(index)) / 1000.0);
+    };
+    object.insert(QStringLiteral("p50Us"), percentile(0.5));
+    object.insert(QStringLiteral("p90Us"), percentile(0.9));
+    object.insert(QStringLiteral("p99Us"), percentile(0.99));
+    object.insert(QStringLiteral("maxUs"), percentile(1.0));
+    return object;
+}
+
+static void printPercentiles(const char *name, const QJsonObject &object)
+{
+    if (object.value(QStringLiteral("count")).toInt() == 0) {
+        std::printf("  %-14s no samples\n", name);
+        return;
+    }
+    std::printf("  %-14s p50 %9.1f us  p90 %9.1f us  p99 %9.1f us  max %9.1f us  (%d samples)\n", name,
+                object.value(QStringLiteral("p50Us")).toDouble(), object.value(QStringLiteral("p90Us")).toDouble(),
+                object.value(QStringLiteral("p99Us")).toDouble(), object.value(QStringLiteral("maxUs")).toDouble(),
+                object.value(QStringLiteral("count")).toInt());
+}
+
+// Presses at "pressPos" (in window coordinates), moves the pointer "steps" times
+// by kStepDelta and releases it. A step has completed once the window geometry
+// has changed and, if "needsFrame" is set, a frame has been painted after that.
+[[nodiscard]] static QJsonObject runScenario(const char *name, QWindow *window, const WindowClock *clock,
+                                             const QPoint &pressPos, const int steps, const bool needsFrame)
+{
+    window->setGeometry(kInitialGeometry);
+    QTest::qWait(100);
+
+    const QPoint pressGlobalPos = window->mapToGlobal(pressPos);
+    const qint64 start = g_clock.nsecsElapsed();
+    QTest::mousePress(window, Qt::LeftButton, Qt::NoModifier, pressPos);
+
+    std::vector<qint64> latencies = {};
+    int timedOut = 0;
+    QPoint localPos = pressPos;
+    for (int step = 1; step <= steps; ++step) {
+        // The pointer moves in screen coordinates, the window may be moving underneath it.
+        localPos = (pressGlobalPos + (kStepDelta * step) - window->position());
+        const QRect geometryBefore = window->geometry();
+        const qint64 stepStart = g_clock.nsecsElapsed();
+        QTest::mouseMove(window, localPos);
+        QElapsedTimer timeout;
+        timeout.start();
+        qint64 stepEnd = -1;
+        while (!timeout.hasExpired(kStepTimeout)) {
+            if (window->geometry() != geometryBefore) {
+                const qint64 geometryChanged = firstAfter(clock->geometryChanges(), stepStart);
+                stepEnd = (needsFrame ? firstAfter(clock->frames(), qMax(geometryChanged, stepStart)) : geometryChanged);
+                if (stepEnd >= 0) {
+                    break;
+                }
+            }
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+        }
+        if (stepEnd >= 0) {
+            latencies.push_back(stepEnd - stepStart);
+        } else {
+            ++timedOut;
+        }
+    }
+
+    QTest::mouseRelease(window, Qt::LeftButton, Qt::NoModifier, localPos);
+    const qint64 end = g_clock.nsecsElapsed();
+
+    std::vector<qint64> frameTimes = {};
+    qint64 previousFrame = -1;
+    for (auto &&frame : clock->frames()) {
+        if ((frame < start) || (frame > end)) {
+            continue;
+        }
+        if (previousFrame >= 0) {
+            frameTimes.push_back(frame - previousFrame);
+        }
+        previousFrame = frame;
+    }
+
+    QJsonObject result = {};
+    result.insert(QStringLiteral("name"), QString::fromLatin1(name));
+    result.insert(QStringLiteral("steps"), steps);
+    result.insert(QStringLiteral("timedOutSteps"), timedOut);
+    result.insert(QStringLiteral("latency"), percentiles(latencies));
+    result.insert(QStringLiteral("frameTime"), percentiles(frameTimes));
+
+    std::printf("%s (%d steps, %d timed out):\n", name, steps, timedOut);
+    printPercentiles("step latency", result.value(QStringLiteral("latency")).toObject());
+    printPercentiles("frame time", result.value(QStringLiteral("frameTime")).toObject());
+    std::fflush(stdout);
+    return result;
+}
+
+[[nodiscard]] static QJsonArray runWidgetScenarios(const int steps)
+{
+    BenchmarkWidget widget;
+    widget.show();
+    if (!QTest::qWaitForWindowExposed(&widget)) {
+        std::fprintf(stderr, "The widget window was never exposed.\n");
+        return {};
+    }
+    QWindow * const window = widget.windowHandle();
+    WindowClock clock(window);
+    widget.setClock(&clock);
+    QJsonArray results = {};
+    // On the title bar, clear of the resize border.
+    results.append(runScenario("widget drag", window, &clock, {100, 15}, steps, false));
+    results.append(runScenario("widget resize", window, &clock,
+                               {kInitialGeometry.width() - 2, kInitialGeometry.height() - 2}, steps, true));
+    return results;
+}
+
+#ifdef BENCHMARK_HAS_QUICK
+[[nodiscard]] static QJsonArray runQuickScenarios(const int steps)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    QQuickStyle::setStyle(QStringLiteral("Basic"));
+#else
+    QQuickStyle::setStyle(QStringLiteral("Default"));
+#endif
+    qmlRegisterSingletonType<UtilFunctions>(qtquicknamespace, 1, 0, "Utils", [](QQmlEngine *engine, QJSEngine *scriptEngine) -> QObject * {
+        Q_UNUSED(engine);
+        Q_UNUSED(scriptEngine);
+        return new UtilFunctions();
+    });
+    qmlRegisterType<FramelessQuickHelper>(qtquicknamespace, 1, 0, "FramelessHelper");
+
+    QQmlApplicationEngine engine;
+    engine.load(QUrl(QStringLiteral("qrc:///qml/main.qml")));
+    const QList<QObject *> rootObjects = engine.rootObjects();
+    const auto window = (rootObjects.isEmpty() ? nullptr : qobject_cast<QQuickWindow *>(rootObjects.first()));
+    if (!window || !QTest::qWaitForWindowExposed(window)) {
+        std::fprintf(stderr, "Failed to show the Qt Quick window.\n");
+        return {};
+    }
+    WindowClock clock(window);
+    QObject::connect(window, &QQuickWindow::frameSwapped, &clock, [&clock](){ clock.recordFrame(); }, Qt::DirectConnection);
+    QJsonArray results = {};
+    results.append(runScenario("quick drag", window, &clock, {100, 15}, steps, false));
+    results.append(runScenario("quick resize", window, &clock,
+                               {kInitialGeometry.width() - 2, kInitialGeometry.height() - 2}, steps, true));
+    return results;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    int steps = 100;
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--steps") == 0) && ((i + 1) < argc)) {
+            steps = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    QCoreApplication::setAttribute(Qt::AA_DontCreateNativeWidgetSiblings);
+    QApplication application(argc, argv);
+    g_clock.start();
+
+    QJsonArray results = runWidgetScenarios(steps);
+#ifdef BENCHMARK_HAS_QUICK
+    const QJsonArray quickResults = runQuickScenarios(steps);
+    for (auto &&result : quickResults) {
+        results.append(result);
+    }
+#endif
+
+    QString filePath = QString::fromLocal8Bit(qgetenv("FRAMELESSHELPER_BENCHMARK_JSON"));
+    if (filePath.isEmpty()) {
+        filePath = QStringLiteral("interactive.json");
+    }
+    QJsonObject root = {};
+    root.insert(QStringLiteral("benchmark"), QStringLiteral("interactive"));
+    root.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    root.insert(QStringLiteral("platform"), QGuiApplication::platformName());
+    root.insert(QStringLiteral("results"), results);
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        std::fprintf(stderr, "Failed to write %s.\n", qPrintable(filePath));
+        return -1;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return 0;
+}
+
+#include "main.moc"
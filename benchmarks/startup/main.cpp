@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Time to first frame of a frameless window, measured from the start of main()
+// to the end of the first paint, with the system probe running on its worker
+// thread (the default) and with the GUI thread waiting for the probe before
+// the window is created, which is what probing on the GUI thread costs.
+//
+// Every sample is a new process. The modes are interleaved so that both see
+// the same disk cache state.
+//
+// Usage: StartupBenchmark [--runs N] [--cold]
+//   --cold  gives every process an empty $XDG_RUNTIME_DIR, so the probe can't
+//           use the theme cache left behind by an earlier process.
+// QT_QPA_PLATFORM=offscreen works fine.
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qrasterwindow.h>
+#include "../../framelesswindowsmanager.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+static constexpr char kChildArgument[] = "--child";
+static constexpr char kBlockingMode[] = "blocking";
+static constexpr char kBackgroundMode[] = "background";
+
+class FirstFrameWindow : public QRasterWindow
+{
+public:
+    explicit FirstFrameWindow(const QElapsedTimer *timer) : m_timer(timer) {}
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        Q_UNUSED(event);
+        QPainter painter(this);
+        painter.fillRect(QRect(QPoint(0, 0), size()), Qt::white);
+        painter.end();
+        if (m_reported) {
+            return;
+        }
+        m_reported = true;
+        std::printf("%lld\n", static_cast<long long>(m_timer->nsecsElapsed()));
+        std::fflush(stdout);
+        QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+    }
+
+private:
+    const QElapsedTimer *m_timer = nullptr;
+    bool m_reported = false;
+};
+
+static int runChild(const QElapsedTimer &timer, int argc, char *argv[], const bool blocking)
+{
+    QGuiApplication application(argc, argv);
+    if (blocking) {
+        FramelessWindowsManager::systemProbe().waitForFinished();
+    }
+    FirstFrameWindow window(&timer);
+    window.resize(800, 600);
+    FramelessWindowsManager::addWindow(&window);
+    window.show();
+    return QGuiApplication::exec();
+}
+
+[[nodiscard]] static qint64 runSample(const QString &program, const char *mode, const bool cold)
+{
+    QTemporaryDir runtimeDir;
+    QProcess process;
+    if (cold && runtimeDir.isValid()) {
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert(QStringLiteral("XDG_RUNTIME_DIR"), runtimeDir.path());
+        process.setProcessEnvironment(environment);
+    }
+    process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process.start(program, {QString::fromLatin1(kChildArgument), QString::fromLatin1(mode)});
+    if (!process.waitForFinished() || (process.exitCode() != 0)) {
+        return -1;
+    }
+    bool ok = false;
+    const qint64 result = process.readAllStandardOutput().trimmed().toLongLong(&ok);
+    return (ok ? result : -1);
+}
+
+static void printResult(const char *mode, std::vector<qint64> &samples)
+{
+    if (samples.empty()) {
+        std::printf("%-12s no samples\n", mode);
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](const double p) -> double {
+        const auto index = static_cast<std::size_t>(p * double(samples.size() - 1) + 0.5);
+        return (double(samples.at(index)) / 1000000.0);
+    };
+    std::printf("%-12s min %8.2f ms  median %8.2f ms  p90 %8.2f ms  max %8.2f ms  (%zu runs)\n",
+                mode, percentile(0.0), percentile(0.5), percentile(0.9), percentile(1.0), samples.size());
+}
+
+int main(int argc, char *argv[])
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if ((argc == 3) && (std::strcmp(argv[1], kChildArgument) == 0)) {
+        return runChild(timer, argc, argv, (std::strcmp(argv[2], kBlockingMode) == 0));
+    }
+
+    int runs = 20;
+    bool cold = false;
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--runs") == 0) && ((i + 1) < argc)) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--cold") == 0) {
+            cold = true;
+        }
+    }
+
+    QCoreApplication application(argc, argv);
+    const QString program = QCoreApplication::applicationFilePath();
+
+    std::vector<qint64> background = {};
+    std::vector<qint64> blocking = {};
+    for (int i = 0; i != runs; ++i) {
+        const qint64 backgroundSample = runSample(program, kBackgroundMode, cold);
+        const qint64 blockingSample = runSample(program, kBlockingMode, cold);
+        if ((backgroundSample < 0) || (blockingSample < 0)) {
+            std::fprintf(stderr, "Run %d failed.\n", i);
+            return -1;
+        }
+        background.push_back(backgroundSample);
+        blocking.push_back(blockingSample);
+    }
+
+    std::printf("Time to first frame%s:\n", (cold ? " (no theme cache)" : ""));
+    printResult(kBackgroundMode, background);
+    printResult(kBlockingMode, blocking);
+    return 0;
+}
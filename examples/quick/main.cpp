@@ -22,71 +22,14 @@
  * SOFTWARE.
  */
 
-#include "../../utilities.h"
 #include "../../framelessquickhelper.h"
+#include "utilfunctions.h"
 #include <QtGui/qguiapplication.h>
 #include <QtQml/qqmlapplicationengine.h>
 #include <QtQuickControls2/qquickstyle.h>
 
 FRAMELESSHELPER_USE_NAMESPACE
 
-static constexpr const char qtquicknamespace[] = "wangwenx190.Utils";
-
-class UtilFunctions : public QObject
-{
-    Q_OBJECT
-    Q_DISABLE_COPY_MOVE(UtilFunctions)
-    Q_PROPERTY(bool isWindowsHost READ isWindowsHost CONSTANT)
-    Q_PROPERTY(bool isWindows10OrGreater READ isWindows10OrGreater CONSTANT)
-    Q_PROPERTY(bool isWindows11OrGreater READ isWindows11OrGreater CONSTANT)
-    Q_PROPERTY(QColor activeFrameBorderColor READ activeFrameBorderColor CONSTANT)
-    Q_PROPERTY(QColor inactiveFrameBorderColor READ inactiveFrameBorderColor CONSTANT)
-    Q_PROPERTY(qreal frameBorderThickness READ frameBorderThickness CONSTANT)
-
-public:
-    explicit UtilFunctions(QObject *parent = nullptr) : QObject(parent) {}
-    ~UtilFunctions() override = default;
-
-    inline bool isWindowsHost() const {
-#ifdef Q_OS_WINDOWS
-        return true;
-#else
-        return false;
-#endif
-    }
-
-    inline bool isWindows10OrGreater() const {
-#ifdef Q_OS_WINDOWS
-        return Utilities::isWin10OrGreater();
-#else
-        return false;
-#endif
-    }
-
-    inline bool isWindows11OrGreater() const {
-#ifdef Q_OS_WINDOWS
-        return Utilities::isWin11OrGreater();
-#else
-        return false;
-#endif
-    }
-
-    inline QColor activeFrameBorderColor() const {
-        const ColorizationArea area = Utilities::getColorizationArea();
-        const bool colorizedBorder = ((area == ColorizationArea::TitleBar_WindowBorder)
-                                      || (area == ColorizationArea::All));
-        return (colorizedBorder ? Utilities::getColorizationColor() : Qt::black);
-    }
-
-    inline QColor inactiveFrameBorderColor() const {
-        return Qt::darkGray;
-    }
-
-    inline qreal frameBorderThickness() const {
-        return 1.0;
-    }
-};
-
 int main(int argc, char *argv[])
 {
     QCoreApplication::setAttribute(Qt::AA_DontCreateNativeWidgetSiblings);
@@ -136,5 +79,3 @@ int main(int argc, char *argv[])
 
     return QGuiApplication::exec();
 }
-
-#include "main.moc"
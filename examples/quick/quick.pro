@@ -1,6 +1,7 @@
 TARGET = Quick
 TEMPLATE = app
 QT += quick quickcontrols2
+HEADERS += utilfunctions.h
 SOURCES += main.cpp
 RESOURCES += qml.qrc
 include($$PWD/../common.pri)
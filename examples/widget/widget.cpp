@@ -127,6 +127,10 @@ void Widget::changeEvent(QEvent *event)
         shouldUpdate = true;
     } else if (event->type() == QEvent::ActivationChange) {
         shouldUpdate = true;
+    } else if (event->type() == QEvent::ThemeChange) {
+        // Platforms without a native theme change notification (e.g. Wayland).
+        updateSystemButtonIcons();
+        shouldUpdate = true;
     }
     if (shouldUpdate) {
         updateStyleSheet();
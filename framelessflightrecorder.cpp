@@ -0,0 +1,378 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessflightrecorder_p.h"
+#include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtGui/qevent.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#ifdef Q_OS_UNIX
+#include <QtCore/qsocketnotifier.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace FramelessFlightRecorder
+{
+
+static constexpr int kRecordCapacity = 4096;
+
+enum class RecordType : qint64
+{
+    Event = 0,
+    HitTest,
+    StateTransition,
+    GeometryCommit
+};
+
+// Every field is an atomic so that a dump running concurrently with a writer
+// is still well defined. The sequence works like a seqlock: it is odd while
+// the record is being written, and "2 * (index + 1)" once record "index" is
+// complete, which also tells the reader whether a slot has been overwritten.
+struct FlightRecord
+{
+    std::atomic<quint64> sequence;
+    std::atomic<qint64> timestamp;
+    std::atomic<quintptr> window;
+    std::atomic<qint64> type;
+    std::atomic<const char *> label;
+    std::array<std::atomic<qint64>, 4> args;
+};
+
+struct FlightRecordCopy
+{
+    qint64 timestamp = 0;
+    quintptr window = 0;
+    RecordType type = RecordType::Event;
+    const char *label = nullptr;
+    std::array<qint64, 4> args = {};
+};
+
+// Plain statics (not Q_GLOBAL_STATIC): they are zero initialized at load
+// time, so the first record doesn't have to allocate anything either.
+static FlightRecord g_records[kRecordCapacity];
+static std::atomic<quint64> g_writeIndex = {0};
+
+[[nodiscard]] static inline qint64 monotonicNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline void writeRecord(const QWindow *window, const RecordType type, const char *label,
+                               const qint64 arg0 = 0, const qint64 arg1 = 0,
+                               const qint64 arg2 = 0, const qint64 arg3 = 0)
+{
+    const quint64 index = g_writeIndex.fetch_add(1, std::memory_order_relaxed);
+    FlightRecord &record = g_records[index % kRecordCapacity];
+    record.sequence.store((index * 2) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.timestamp.store(monotonicNanoseconds(), std::memory_order_relaxed);
+    record.window.store(reinterpret_cast<quintptr>(window), std::memory_order_relaxed);
+    record.type.store(static_cast<qint64>(type), std::memory_order_relaxed);
+    record.label.store(label, std::memory_order_relaxed);
+    record.args[0].store(arg0, std::memory_order_relaxed);
+    record.args[1].store(arg1, std::memory_order_relaxed);
+    record.args[2].store(arg2, std::memory_order_relaxed);
+    record.args[3].store(arg3, std::memory_order_relaxed);
+    record.sequence.store((index + 1) * 2, std::memory_order_release);
+}
+
+[[nodiscard]] static inline bool readRecord(const quint64 index, FlightRecordCopy *copy)
+{
+    Q_ASSERT(copy);
+    if (!copy) {
+        return false;
+    }
+    const FlightRecord &record = g_records[index % kRecordCapacity];
+    const quint64 sequence = record.sequence.load(std::memory_order_acquire);
+    if (sequence != ((index + 1) * 2)) {
+        // Overwritten already, or still being written.
+        return false;
+    }
+    copy->timestamp = record.timestamp.load(std::memory_order_relaxed);
+    copy->window = record.window.load(std::memory_order_relaxed);
+    copy->type = static_cast<RecordType>(record.type.load(std::memory_order_relaxed));
+    copy->label = record.label.load(std::memory_order_relaxed);
+    for (int i = 0; i != 4; ++i) {
+        copy->args[i] = record.args[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (record.sequence.load(std::memory_order_relaxed) == sequence);
+}
+
+[[nodiscard]] static inline const char *eventTypeName(const int type)
+{
+    switch (static_cast<QEvent::Type>(type)) {
+    case QEvent::MouseButtonPress:
+        return "MouseButtonPress";
+    case QEvent::MouseButtonRelease:
+        return "MouseButtonRelease";
+    case QEvent::MouseButtonDblClick:
+        return "MouseButtonDblClick";
+    case QEvent::MouseMove:
+        return "MouseMove";
+    default:
+        break;
+    }
+    return "Event";
+}
+
+[[nodiscard]] static inline const char *stateName(const qint64 state)
+{
+    switch (static_cast<InteractionState>(state)) {
+    case InteractionState::Idle:
+        return "Idle";
+    case InteractionState::Moving:
+        return "Moving";
+    case InteractionState::Resizing:
+        return "Resizing";
+    }
+    return "Unknown";
+}
+
+void recordEvent(const QWindow *window, const int eventType, const QPoint &localPos, const int buttons)
+{
+    writeRecord(window, RecordType::Event, eventTypeName(eventType), localPos.x(), localPos.y(), buttons);
+}
+
+void recordHitTest(const QWindow *window, const QPoint &localPos, const char *label)
+{
+    writeRecord(window, RecordType::HitTest, label, localPos.x(), localPos.y());
+}
+
+void recordStateTransition(const QWindow *window, const InteractionState from, const InteractionState to)
+{
+    writeRecord(window, RecordType::StateTransition, stateName(static_cast<qint64>(to)),
+                static_cast<qint64>(from), static_cast<qint64>(to));
+}
+
+void recordGeometryCommit(const QWindow *window, const QRect &geometry)
+{
+    writeRecord(window, RecordType::GeometryCommit, "GeometryCommit",
+                geometry.x(), geometry.y(), geometry.width(), geometry.height());
+}
+
+[[nodiscard]] static inline QJsonObject recordArguments(const FlightRecordCopy &record)
+{
+    switch (record.type) {
+    case RecordType::Event:
+        return {
+            {QStringLiteral("x"), record.args[0]},
+            {QStringLiteral("y"), record.args[1]},
+            {QStringLiteral("buttons"), record.args[2]}
+        };
+    case RecordType::HitTest:
+        return {
+            {QStringLiteral("x"), record.args[0]},
+            {QStringLiteral("y"), record.args[1]}
+        };
+    case RecordType::StateTransition:
+        return {
+            {QStringLiteral("from"), QString::fromLatin1(stateName(record.args[0]))},
+            {QStringLiteral("to"), QString::fromLatin1(stateName(record.args[1]))}
+        };
+    case RecordType::GeometryCommit:
+        return {
+            {QStringLiteral("x"), record.args[0]},
+            {QStringLiteral("y"), record.args[1]},
+            {QStringLiteral("width"), record.args[2]},
+            {QStringLiteral("height"), record.args[3]}
+        };
+    }
+    return {};
+}
+
+[[nodiscard]] static inline QString recordCategory(const RecordType type)
+{
+    switch (type) {
+    case RecordType::Event:
+        return QStringLiteral("event");
+    case RecordType::HitTest:
+        return QStringLiteral("hittest");
+    case RecordType::StateTransition:
+        return QStringLiteral("state");
+    case RecordType::GeometryCommit:
+        return QStringLiteral("geometry");
+    }
+    return {};
+}
+
+bool dump(const QString &filePath)
+{
+    Q_ASSERT(!filePath.isEmpty());
+    if (filePath.isEmpty()) {
+        return false;
+    }
+    const quint64 end = g_writeIndex.load(std::memory_order_acquire);
+    const quint64 begin = ((end > quint64(kRecordCapacity)) ? (end - kRecordCapacity) : 0);
+    QList<FlightRecordCopy> records = {};
+    records.reserve(static_cast<int>(end - begin));
+    for (quint64 i = begin; i != end; ++i) {
+        FlightRecordCopy record = {};
+        if (readRecord(i, &record)) {
+            records.append(record);
+        }
+    }
+    const qint64 pid = QCoreApplication::applicationPid();
+    const qint64 origin = (records.isEmpty() ? 0 : records.constFirst().timestamp);
+    // Every window gets its own track in the trace viewer.
+    QHash<quintptr, int> windowTracks = {};
+    QJsonArray events = {};
+    for (auto &&record : qAsConst(records)) {
+        auto it = windowTracks.find(record.window);
+        if (it == windowTracks.end()) {
+            it = windowTracks.insert(record.window, windowTracks.size() + 1);
+            events.append(QJsonObject{
+                {QStringLiteral("name"), QStringLiteral("thread_name")},
+                {QStringLiteral("ph"), QStringLiteral("M")},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("tid"), it.value()},
+                {QStringLiteral("args"), QJsonObject{
+                     {QStringLiteral("name"), QStringLiteral("Window 0x%1").arg(record.window, 0, 16)}
+                 }}
+            });
+        }
+        events.append(QJsonObject{
+            {QStringLiteral("name"), QString::fromLatin1(record.label)},
+            {QStringLiteral("cat"), recordCategory(record.type)},
+            {QStringLiteral("ph"), QStringLiteral("i")},
+            {QStringLiteral("s"), QStringLiteral("t")},
+            // Chrome traces use microseconds.
+            {QStringLiteral("ts"), (static_cast<qreal>(record.timestamp - origin) / 1000.0)},
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("tid"), it.value()},
+            {QStringLiteral("args"), recordArguments(record)}
+        });
+    }
+    const QJsonObject root = {
+        {QStringLiteral("traceEvents"), events},
+        {QStringLiteral("displayTimeUnit"), QStringLiteral("ns")}
+    };
+    QSaveFile file(filePath);
+    if (!file.open(QSaveFile::WriteOnly)) {
+        qWarning() << "Failed to open" << filePath << "for dumping the flight recorder:" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "Failed to write" << filePath << ':' << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void clear()
+{
+    // Invalidate all the records without touching them: the reader only
+    // accepts a record whose sequence matches its own index.
+    g_writeIndex.fetch_add(kRecordCapacity, std::memory_order_relaxed);
+}
+
+#ifdef Q_OS_UNIX
+static int g_signalPipe[2] = {-1, -1};
+
+static void dumpSignalHandler(int signal)
+{
+    Q_UNUSED(signal);
+    const char byte = 0;
+    // Only async-signal-safe calls are allowed here, the dump itself runs
+    // from the event loop.
+    [[maybe_unused]] const auto written = ::write(g_signalPipe[1], &byte, 1);
+}
+
+struct FlightRecorderSignalData
+{
+    QScopedPointer<QSocketNotifier> notifier;
+    struct sigaction previousAction = {};
+};
+
+Q_GLOBAL_STATIC(FlightRecorderSignalData, g_flightRecorderSignalData)
+
+static inline void dumpToTemporaryDirectory()
+{
+    char buffer[64];
+    while (::read(g_signalPipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+    const QString filePath = QDir::temp().filePath(QStringLiteral("framelesshelper-flightrecord-%1-%2.json")
+                                                   .arg(QCoreApplication::applicationPid())
+                                                   .arg(QDateTime::currentMSecsSinceEpoch()));
+    if (dump(filePath)) {
+        qInfo() << "FramelessHelper flight recorder dumped to" << filePath;
+    }
+}
+#endif
+
+void setDumpOnSignalEnabled(const bool value)
+{
+#ifdef Q_OS_UNIX
+    FlightRecorderSignalData * const data = g_flightRecorderSignalData();
+    if (value == !data->notifier.isNull()) {
+        return;
+    }
+    if (value) {
+        if (::pipe(g_signalPipe) != 0) {
+            qWarning() << "Failed to create the flight recorder signal pipe.";
+            return;
+        }
+        for (auto &&fd : g_signalPipe) {
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        data->notifier.reset(new QSocketNotifier(g_signalPipe[0], QSocketNotifier::Read));
+        QObject::connect(data->notifier.data(), &QSocketNotifier::activated, dumpToTemporaryDirectory);
+        struct sigaction action = {};
+        action.sa_handler = dumpSignalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        ::sigaction(SIGUSR1, &action, &data->previousAction);
+    } else {
+        ::sigaction(SIGUSR1, &data->previousAction, nullptr);
+        data->notifier.reset();
+        for (auto &&fd : g_signalPipe) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+#else
+    Q_UNUSED(value);
+#endif
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
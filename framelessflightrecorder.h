@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// A fixed-size ring buffer which always records the last few thousand
+// interaction events of the frameless windows (the mouse events received,
+// the hit test results, the move/resize state transitions and the geometry
+// commits). Recording never allocates or locks. The content can be written
+// out as a Chrome trace file (chrome://tracing, Perfetto) at any time.
+namespace FramelessFlightRecorder
+{
+
+[[nodiscard]] FRAMELESSHELPER_API bool dump(const QString &filePath);
+FRAMELESSHELPER_API void clear();
+
+// Dumps the recorder into the temporary directory whenever the process
+// receives SIGUSR1. Unix only, disabled by default.
+FRAMELESSHELPER_API void setDumpOnSignalEnabled(const bool value = true);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -27,13 +27,141 @@
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 9, 0))
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qvariant.h>
 #include <QtGui/qevent.h>
 #include <QtGui/qwindow.h>
-#include "framelesswindowsmanager.h"
+#include "framelesswindowsmanager_p.h"
+#include "framelessinputrecorder.h"
+#include "framelesswindowstatistics_p.h"
+#include "framelessflightrecorder_p.h"
+#include "framelesshelper_trace_p.h"
+#include "framelessliveresize_p.h"
+#include "framelessscreenindex_p.h"
+#include "framelessmagnetism_p.h"
+#include "framelesswindowgroup_p.h"
+#include "framelessscreenchange_p.h"
 #include "utilities.h"
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
+// How close to the edge of a work area the pointer has to get to snap the window to it.
+static constexpr int kEdgeSnappingThreshold = 8;
+
+[[nodiscard]] static inline QPoint globalMousePosition(const QMouseEvent *event)
+{
+    Q_ASSERT(event);
+    if (!event) {
+        return {};
+    }
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    return event->globalPosition().toPoint();
+#else
+    return event->globalPos();
+#endif
+}
+
+[[nodiscard]] static inline const char *edgesLabel(const Qt::Edges edges)
+{
+    if (edges == (Qt::TopEdge | Qt::LeftEdge)) {
+        return "TopLeft";
+    }
+    if (edges == (Qt::TopEdge | Qt::RightEdge)) {
+        return "TopRight";
+    }
+    if (edges == (Qt::BottomEdge | Qt::LeftEdge)) {
+        return "BottomLeft";
+    }
+    if (edges == (Qt::BottomEdge | Qt::RightEdge)) {
+        return "BottomRight";
+    }
+    if (edges == Qt::TopEdge) {
+        return "Top";
+    }
+    if (edges == Qt::BottomEdge) {
+        return "Bottom";
+    }
+    if (edges == Qt::LeftEdge) {
+        return "Left";
+    }
+    if (edges == Qt::RightEdge) {
+        return "Right";
+    }
+    return "Client";
+}
+
+// The per-window settings are dynamic properties, and reading one back (and
+// copying the hit test visible object list out of its QVariant) is far from
+// free, so the event filter works on a copy which is only refreshed when a
+// dynamic property of the window has changed.
+struct FramelessWindowSettings
+{
+    bool valid = false;
+    int resizeBorderThickness = 0;
+    int titleBarHeight = 0;
+    bool fixedSize = false;
+    MoveResizeMode moveResizeMode = MoveResizeMode::Manual;
+    LiveResizeMode liveResizeMode = LiveResizeMode::Default;
+    bool edgeSnapping = false;
+    bool consumeMouseEvents = false;
+    QObjectList hitTestVisibleObjects = {};
+};
+
+// What the event filter has to remember about the interaction with a window
+// from one mouse event to the next.
+struct FramelessInteractionState
+{
+    bool titlebarClicked = false;
+    bool cursorChanged = false;
+    QPoint dragGlobalPos = {};
+    QPoint resizeGlobalPos = {};
+    QRect origRect = {};
+    Qt::Edges resizeEdges = {};
+    GeometryConstraints resizeConstraints = {};
+    ScreenIndex::SnapZone snapZone = ScreenIndex::SnapZone::None;
+    QRect snapGeometry = {};
+    // Where the window would be without magnetism, it only sticks to an edge
+    // while this stays within reach of it.
+    QRect freeGeometry = {};
+    // The group members moving along with the window, it must not stick to them.
+    QWindowList magnetismIgnored = {};
+};
+
+struct FramelessHelperData
+{
+    QHash<const QWindow *, FramelessWindowSettings> settings = {};
+    // The last geometry each window had while it was neither maximized nor
+    // full screen, what a drag on the title bar restores it to.
+    QHash<const QWindow *, QRect> normalGeometries = {};
+    QHash<const QWindow *, FramelessInteractionState> interactions = {};
+    // The window whose move or resize has been handed over to the window manager.
+    QPointer<QWindow> systemMoveResizeWindow = nullptr;
+};
+
+Q_GLOBAL_STATIC(FramelessHelperData, g_framelessHelperData)
+
+[[nodiscard]] static inline const FramelessWindowSettings &windowSettings(const QWindow *window)
+{
+    Q_ASSERT(window);
+    FramelessWindowSettings &settings = g_framelessHelperData()->settings[window];
+    if (FramelessWindowStatistics * const statistics = WindowStatistics::get(window)) {
+        ++(settings.valid ? statistics->settingsCacheHits : statistics->settingsCacheMisses);
+    }
+    if (!settings.valid) {
+        settings.resizeBorderThickness = window->property(Constants::kResizeBorderThicknessFlag).toInt();
+        settings.titleBarHeight = window->property(Constants::kTitleBarHeightFlag).toInt();
+        settings.fixedSize = window->property(Constants::kWindowFixedSizeFlag).toBool();
+        settings.moveResizeMode = static_cast<MoveResizeMode>(window->property(Constants::kMoveResizeModeFlag).toInt());
+        settings.liveResizeMode = static_cast<LiveResizeMode>(window->property(Constants::kLiveResizeModeFlag).toInt());
+        settings.edgeSnapping = window->property(Constants::kEdgeSnappingFlag).toBool();
+        settings.consumeMouseEvents = window->property(Constants::kConsumeMouseEventsFlag).toBool();
+        settings.hitTestVisibleObjects = qvariant_cast<QObjectList>(window->property(Constants::kHitTestVisibleFlag));
+        settings.valid = true;
+    }
+    return settings;
+}
+
 FramelessHelper::FramelessHelper(QObject *parent) : QObject(parent) {}
 
 void FramelessHelper::removeWindowFrame(QWindow *window)
@@ -45,6 +173,16 @@ void FramelessHelper::removeWindowFrame(QWindow *window)
     window->setFlags(window->flags() | Qt::FramelessWindowHint);
     window->installEventFilter(this);
     window->setProperty(Constants::kFramelessModeFlag, true);
+    g_framelessHelperData()->normalGeometries.insert(window, window->geometry());
+    connect(window, &QWindow::destroyed, this, [window](){
+        g_framelessHelperData()->settings.remove(window);
+        g_framelessHelperData()->normalGeometries.remove(window);
+        g_framelessHelperData()->interactions.remove(window);
+        WindowMagnetism::remove(window);
+        ScreenChangeDeferral::remove(window);
+        WindowStatistics::remove(window);
+    }, Qt::UniqueConnection);
+    WindowMagnetism::update(window);
 }
 
 void FramelessHelper::bringBackWindowFrame(QWindow *window)
@@ -56,6 +194,13 @@ void FramelessHelper::bringBackWindowFrame(QWindow *window)
     window->removeEventFilter(this);
     window->setFlags(window->flags() & ~Qt::FramelessWindowHint);
     window->setProperty(Constants::kFramelessModeFlag, false);
+    g_framelessHelperData()->settings.remove(window);
+    g_framelessHelperData()->normalGeometries.remove(window);
+    g_framelessHelperData()->interactions.remove(window);
+    if (g_framelessHelperData()->systemMoveResizeWindow == window) {
+        g_framelessHelperData()->systemMoveResizeWindow = nullptr;
+    }
+    WindowMagnetism::remove(window);
 }
 
 bool FramelessHelper::eventFilter(QObject *object, QEvent *event)
@@ -70,22 +215,72 @@ bool FramelessHelper::eventFilter(QObject *object, QEvent *event)
         return false;
     }
     const QEvent::Type type = event->type();
+    if (type == QEvent::PlatformSurface) {
+        if (static_cast<QPlatformSurfaceEvent *>(event)->surfaceEventType() == QPlatformSurfaceEvent::SurfaceCreated) {
+            CursorPrewarming::schedule(static_cast<QWindow *>(object));
+        }
+        return false;
+    }
+    if (type == QEvent::DynamicPropertyChange) {
+        const auto it = g_framelessHelperData()->settings.find(static_cast<QWindow *>(object));
+        if (it != g_framelessHelperData()->settings.end()) {
+            it->valid = false;
+        }
+        return false;
+    }
+    if ((type == QEvent::Move) || (type == QEvent::Resize)) {
+        // The window manager has answered a configure request.
+        const auto window = static_cast<QWindow *>(object);
+        WindowStatistics::recordGeometryAck(window);
+        if (window->windowState() == Qt::WindowNoState) {
+            g_framelessHelperData()->normalGeometries.insert(window, window->geometry());
+        }
+        WindowMagnetism::update(window);
+        ScreenChangeDeferral::windowMoved(window);
+        return false;
+    }
+    if (ScreenChangeDeferral::isScreenChangeEvent(type)) {
+        return ScreenChangeDeferral::defer(static_cast<QWindow *>(object), type);
+    }
+    if ((type == QEvent::Show) || (type == QEvent::Hide) || (type == QEvent::WindowStateChange)) {
+        WindowMagnetism::update(static_cast<QWindow *>(object));
+        return false;
+    }
     // We are only interested in mouse events.
     if ((type != QEvent::MouseButtonDblClick) && (type != QEvent::MouseButtonPress)
             && (type != QEvent::MouseMove) && (type != QEvent::MouseButtonRelease)) {
         return false;
     }
     const auto window = qobject_cast<QWindow *>(object);
-    const int resizeBorderThickness = FramelessWindowsManager::getResizeBorderThickness(window);
-    const int titleBarHeight = FramelessWindowsManager::getTitleBarHeight(window);
-    const bool resizable = FramelessWindowsManager::getResizable(window);
+    const FramelessWindowSettings &settings = windowSettings(window);
+    const int resizeBorderThickness = ((settings.resizeBorderThickness > 0) ? settings.resizeBorderThickness
+        : Utilities::getSystemMetric(window, SystemMetric::ResizeBorderThickness, false, true));
+    const int titleBarHeight = ((settings.titleBarHeight > 0) ? settings.titleBarHeight : 31);
+    const bool resizable = !settings.fixedSize;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+    const bool systemMoveResize = (settings.moveResizeMode == MoveResizeMode::System);
+#else
+    const bool systemMoveResize = false;
+#endif
+    const bool outline = (settings.liveResizeMode == LiveResizeMode::Outline);
+    const bool edgeSnapping = settings.edgeSnapping;
+    const bool consumeMouseEvents = settings.consumeMouseEvents;
+    // Whether this event has been fully taken care of here (dragging,
+    // resizing), only used if the window wants such events to be consumed.
+    bool handled = false;
+    const QObjectList &hitTestVisibleObjects = settings.hitTestVisibleObjects;
     const int windowWidth = window->width();
     const auto mouseEvent = static_cast<QMouseEvent *>(event);
+    FRAMELESSHELPER_TRACE(eventFilter_entry, window, type);
+    FramelessInputRecorder::recordEvent(window, mouseEvent);
+    const WindowStatistics::EventFilterScope statisticsScope(window);
+    FramelessWindowStatistics * const statistics = WindowStatistics::get(window);
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
     const QPoint localMousePosition = mouseEvent->position().toPoint();
 #else
     const QPoint localMousePosition = mouseEvent->windowPos().toPoint();
 #endif
+    FramelessFlightRecorder::recordEvent(window, type, localMousePosition, static_cast<int>(mouseEvent->buttons()));
      const Qt::Edges edges = [window, resizeBorderThickness, windowWidth, &localMousePosition] {
         const int windowHeight = window->height();
         if (localMousePosition.y() <= resizeBorderThickness) {
@@ -114,172 +309,319 @@ bool FramelessHelper::eventFilter(QObject *object, QEvent *event)
         }
         return Qt::Edges{};
     } ();
-    const bool hitTestVisible = Utilities::isHitTestVisible(window);
-    bool isInTitlebarArea = false;
-    if ((window->windowState() == Qt::WindowMaximized)
-            || (window->windowState() == Qt::WindowFullScreen)) {
-        isInTitlebarArea = (localMousePosition.y() >= 0)
-                && (localMousePosition.y() <= titleBarHeight)
-                && (localMousePosition.x() >= 0)
-                && (localMousePosition.x() <= windowWidth)
-                && !hitTestVisible;
-    }
-    if (window->windowState() == Qt::WindowNoState) {
-        isInTitlebarArea = (localMousePosition.y() > resizeBorderThickness)
-                && (localMousePosition.y() <= titleBarHeight)
-                && (localMousePosition.x() > resizeBorderThickness)
-                && (localMousePosition.x() < (windowWidth - resizeBorderThickness))
-                && !hitTestVisible;
+    const QPoint globalMousePos = globalMousePosition(mouseEvent);
+    // Hit testing the child controls is not free, so only do it for the
+    // events which actually need it (presses and double clicks), and use the
+    // position carried by the event instead of querying the cursor position.
+    const auto isInTitlebarArea = [window, titleBarHeight, resizeBorderThickness, windowWidth, statistics,
+                                   &hitTestVisibleObjects, &localMousePosition, &globalMousePos]() -> bool {
+        bool inArea = false;
+        if ((window->windowState() == Qt::WindowMaximized)
+                || (window->windowState() == Qt::WindowFullScreen)) {
+            inArea = (localMousePosition.y() >= 0)
+                    && (localMousePosition.y() <= titleBarHeight)
+                    && (localMousePosition.x() >= 0)
+                    && (localMousePosition.x() <= windowWidth);
+        }
+        if (window->windowState() == Qt::WindowNoState) {
+            inArea = (localMousePosition.y() > resizeBorderThickness)
+                    && (localMousePosition.y() <= titleBarHeight)
+                    && (localMousePosition.x() > resizeBorderThickness)
+                    && (localMousePosition.x() < (windowWidth - resizeBorderThickness));
+        }
+        if (!inArea) {
+            FramelessFlightRecorder::recordHitTest(window, localMousePosition, "Client");
+            FRAMELESSHELPER_TRACE(hitTest, window, localMousePosition.x(), localMousePosition.y(), "Client");
+            return false;
+        }
+        if (statistics) {
+            ++statistics->hitTests;
+        }
+        const bool titleBar = !Utilities::isHitTestVisible(hitTestVisibleObjects, globalMousePos);
+        const char * const hitTestResult = (titleBar ? "TitleBar" : "HitTestVisible");
+        FramelessFlightRecorder::recordHitTest(window, localMousePosition, hitTestResult);
+        FRAMELESSHELPER_TRACE(hitTest, window, localMousePosition.x(), localMousePosition.y(), hitTestResult);
+        return titleBar;
+    };
+    const auto setCursorShape = [window, statistics](const Qt::CursorShape shape) {
+        // Hovering along an edge keeps asking for the same shape.
+        if (window->cursor().shape() == shape) {
+            return;
+        }
+        if (statistics) {
+            ++statistics->cursorChanges;
+        }
+        window->setCursor(shape);
+    };
+    const auto commitGeometry = [window, statistics, mouseEvent](const QRect &geometry, const bool positionOnly) {
+        if (positionOnly) {
+            window->setPosition(geometry.topLeft());
+        } else {
+            window->setGeometry(geometry);
+        }
+        FramelessFlightRecorder::recordGeometryCommit(window, geometry);
+        FRAMELESSHELPER_TRACE(setGeometry, window, geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        if (statistics) {
+            WindowStatistics::recordGeometryCommit(window, mouseEvent->timestamp());
+        }
+        // The members of the window group (if any) go out in the same batch.
+        WindowGroup::commit(window, geometry.topLeft());
+    };
+    // In outline mode only the outline follows the pointer, the window itself
+    // gets its final geometry in one go when the button is released.
+    const auto currentGeometry = [window, outline]() -> QRect {
+        const QRect outlineGeometry = (outline ? LiveResize::outlineGeometry(window) : QRect{});
+        return (outlineGeometry.isValid() ? outlineGeometry : window->geometry());
+    };
+    const auto trackGeometry = [window, outline, &commitGeometry](const QRect &geometry, const bool positionOnly) {
+        if (outline) {
+            LiveResize::showOutline(window, geometry);
+        } else {
+            commitGeometry(geometry, positionOnly);
+        }
+    };
+
+    // The window manager grabs the pointer for the whole interaction once it
+    // has been handed over, so the next mouse event we get (whichever window
+    // it is for) means it's over.
+    if (const QPointer<QWindow> systemMoveResizeWindow = g_framelessHelperData()->systemMoveResizeWindow) {
+        g_framelessHelperData()->systemMoveResizeWindow = nullptr;
+        WindowInteraction::setState(systemMoveResizeWindow, WindowInteraction::State::Idle, Qt::Edges{});
+        // There may be no release, don't let a later one be taken for ours.
+        const auto it = g_framelessHelperData()->interactions.find(systemMoveResizeWindow);
+        if (it != g_framelessHelperData()->interactions.end()) {
+            it->resizeEdges = Qt::Edges{};
+        }
     }
+    FramelessInteractionState &interaction = g_framelessHelperData()->interactions[window];
+    const auto transitionTo = [window, &interaction](const WindowInteraction::State state) {
+        WindowInteraction::setState(window, state, interaction.resizeEdges);
+    };
+    const auto startSystemMoveResize = [window, statistics](const Qt::Edges edges) -> bool {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+        if (edges != Qt::Edges{}) {
+            // Qt rewrites WM_NORMAL_HINTS whenever the geometry or the size
+            // limits change and leaves out the aspect ratio, publish it again.
+            Utilities::updateWindowSizeHints(window);
+        }
+#endif
+        const bool started = ((edges == Qt::Edges{}) ? window->startSystemMove() : window->startSystemResize(edges));
+        if (started && statistics) {
+            ++statistics->systemMoveResizeRequests;
+        }
+        return started;
+#else
+        Q_UNUSED(window);
+        Q_UNUSED(statistics);
+        Q_UNUSED(edges);
+        return false;
+#endif
+    };
 
     // Determine if the mouse click occurred in the title bar
 
-    static bool titlebarClicked = false;
-    static QPoint dragGlobalPos;
+    // Leaving the maximized (or full screen) state by dragging the title bar:
+    // the restored geometry is worked out up front and sent right after the
+    // state change, instead of restoring first and moving the window to where
+    // it should be once the new size is known.
+    const auto restoreForDrag = [window, &interaction, &globalMousePos, &commitGeometry]() {
+        const QRect maximized = window->geometry();
+        QSize restoredSize = g_framelessHelperData()->normalGeometries.value(window).size();
+        if (!restoredSize.isValid() || (restoredSize == maximized.size())) {
+            restoredSize = ((maximized.size() * 2) / 3).expandedTo(window->minimumSize()).boundedTo(window->maximumSize());
+        }
+        const QRect restored = Utilities::calculateRestoreGeometry(maximized, restoredSize, interaction.dragGlobalPos, globalMousePos);
+        window->setWindowState(Qt::WindowState::WindowNoState);
+        commitGeometry(restored, false);
+        interaction.dragGlobalPos = globalMousePos;
+    };
     if (type == QEvent::MouseButtonPress) {
-        if (isInTitlebarArea)
-            titlebarClicked = true;
+        if (isInTitlebarArea())
+            interaction.titlebarClicked = true;
         else
-            titlebarClicked = false;
+            interaction.titlebarClicked = false;
         if (mouseEvent->button() == Qt::LeftButton)
         {
-            dragGlobalPos = mouseEvent->globalPos();
+            interaction.dragGlobalPos = globalMousePos;
+            if (interaction.titlebarClicked) {
+                // Fall back to moving the window ourself if the window manager refuses.
+                if (systemMoveResize && (window->windowState() == Qt::WindowNoState)
+                        && startSystemMoveResize(Qt::Edges{})) {
+                    interaction.titlebarClicked = false;
+                    g_framelessHelperData()->systemMoveResizeWindow = window;
+                    transitionTo(WindowInteraction::State::Moving);
+                    // The window manager grabs the pointer, the release would never come.
+                    handled = true;
+                }
+            }
         }
     }
 
-    static QPoint resizeGlobalPos;
-    static QRect origRect;
-    static Qt::Edges resizeEdges;
     if (type == QEvent::MouseButtonDblClick) {
-        if (isInTitlebarArea) {
+        if (isInTitlebarArea()) {
             if (window->windowState() == Qt::WindowState::WindowMaximized || window->windowState() == Qt::WindowState::WindowFullScreen) {
                 window->setWindowState(Qt::WindowState::WindowNoState);
             } else if(window->windowState() == Qt::WindowState::WindowNoState){
                 window->setWindowState(Qt::WindowState::WindowMaximized);
             }
-            window->setCursor(Qt::ArrowCursor);
+            setCursorShape(Qt::ArrowCursor);
         }
     } else if (type == QEvent::MouseMove) {
         // Display resize indicators
-        static bool cursorChanged = false;
         if ((window->windowState() == Qt::WindowState::WindowNoState) && resizable) {
             if (((edges & Qt::TopEdge) && (edges & Qt::LeftEdge))
                     || ((edges & Qt::BottomEdge) && (edges & Qt::RightEdge))) {
-                window->setCursor(Qt::SizeFDiagCursor);
-                cursorChanged = true;
+                setCursorShape(Qt::SizeFDiagCursor);
+                interaction.cursorChanged = true;
             } else if (((edges & Qt::TopEdge) && (edges & Qt::RightEdge))
                        || ((edges & Qt::BottomEdge) && (edges & Qt::LeftEdge))) {
-                window->setCursor(Qt::SizeBDiagCursor);
-                cursorChanged = true;
+                setCursorShape(Qt::SizeBDiagCursor);
+                interaction.cursorChanged = true;
             } else if ((edges & Qt::TopEdge) || (edges & Qt::BottomEdge)) {
-                window->setCursor(Qt::SizeVerCursor);
-                cursorChanged = true;
+                setCursorShape(Qt::SizeVerCursor);
+                interaction.cursorChanged = true;
             } else if ((edges & Qt::LeftEdge) || (edges & Qt::RightEdge)) {
-                window->setCursor(Qt::SizeHorCursor);
-                cursorChanged = true;
+                setCursorShape(Qt::SizeHorCursor);
+                interaction.cursorChanged = true;
             } else {
-                if (cursorChanged) {
-                    window->setCursor(Qt::ArrowCursor);
-                    cursorChanged = false;
+                if (interaction.cursorChanged) {
+                    setCursorShape(Qt::ArrowCursor);
+                    interaction.cursorChanged = false;
                 }
             }
         }
 
-        if ((mouseEvent->buttons() & Qt::LeftButton) && titlebarClicked) {
+        if ((mouseEvent->buttons() & Qt::LeftButton) && interaction.titlebarClicked) {
+            handled = true;
             window->unsetCursor();
-            if(window->windowState() == Qt::WindowState::WindowMaximized || window->windowState() == Qt::WindowState::WindowFullScreen)
+            // Every position change is a round trip to the window manager,
+            // don't send the ones which wouldn't move the window.
+            const QPoint delta = (globalMousePos - interaction.dragGlobalPos);
+            if (window->windowState() == Qt::WindowState::WindowMaximized || window->windowState() == Qt::WindowState::WindowFullScreen)
             {
-                window->setWindowState(Qt::WindowState::WindowNoState);
-                window->setPosition(QPoint(dragGlobalPos.x() - window->geometry().width()/2, 0));
-            }
-            window->setPosition(window->position() + (mouseEvent->globalPos() - dragGlobalPos));
-            dragGlobalPos = mouseEvent->globalPos();
-        }
-        if(!resizeGlobalPos.isNull())
-        {
-            int y0 = (mouseEvent->globalPos() - resizeGlobalPos).y();
-            int x0 = (mouseEvent->globalPos() - resizeGlobalPos).x();
-            int minWidth = window->minimumWidth();
-            int minHeight = window->minimumHeight();
-            if(resizeEdges & Qt::LeftEdge)
-            {
-                if(minWidth > origRect.width() - x0)
-                {
-                    x0 = origRect.width() - minWidth;
+                if (!delta.isNull()) {
+                    restoreForDrag();
+                    transitionTo(WindowInteraction::State::Moving);
+                    // The window manager takes over from the restored geometry.
+                    if (systemMoveResize && startSystemMoveResize(Qt::Edges{})) {
+                        interaction.titlebarClicked = false;
+                        g_framelessHelperData()->systemMoveResizeWindow = window;
+                    }
                 }
-            }
-            if(resizeEdges & Qt::TopEdge)
-            {
-                if(minHeight > origRect.height() - y0)
-                {
-                    y0 = origRect.height() - minHeight;
+            } else if (!delta.isNull()) {
+                // A click on the title bar isn't a move yet.
+                transitionTo(WindowInteraction::State::Moving);
+                if (WindowMagnetism::isEnabled()) {
+                    if (!interaction.freeGeometry.isValid()) {
+                        interaction.freeGeometry = currentGeometry();
+                        interaction.magnetismIgnored = WindowGroup::members(window);
+                    }
+                    interaction.freeGeometry.translate(delta);
+                    const QRect geometry = WindowMagnetism::snap(window, interaction.freeGeometry,
+                                                                 interaction.magnetismIgnored);
+                    if (geometry != currentGeometry()) {
+                        trackGeometry(geometry, true);
+                    } else if (statistics) {
+                        ++statistics->commitsCoalesced;
+                    }
+                } else {
+                    trackGeometry(currentGeometry().translated(delta), true);
                 }
-            }
-            if(resizeEdges & Qt::RightEdge)
-            {
-                if(minWidth > origRect.width() + x0)
-                {
-                    x0 = minWidth - origRect.width();
+                interaction.dragGlobalPos = globalMousePos;
+                if (edgeSnapping) {
+                    QRect geometry = {};
+                    const ScreenIndex::SnapZone zone = ScreenIndex::snapZone(globalMousePos, kEdgeSnappingThreshold, &geometry);
+                    if ((zone != interaction.snapZone) || (geometry != interaction.snapGeometry)) {
+                        interaction.snapZone = zone;
+                        interaction.snapGeometry = geometry;
+                        if (zone == ScreenIndex::SnapZone::None) {
+                            LiveResize::hideSnapPreview(window);
+                        } else {
+                            LiveResize::showSnapPreview(window, geometry);
+                        }
+                    }
                 }
+            } else if (statistics) {
+                ++statistics->commitsCoalesced;
             }
-            if(resizeEdges & Qt::BottomEdge)
-            {
-                if(minHeight > origRect.height() + y0)
-                {
-                    y0 = minHeight - origRect.height();
-                }
-            }
-            if((resizeEdges & Qt::TopEdge) && (resizeEdges & Qt::LeftEdge))
-            {
-                window->setGeometry(origRect.adjusted(x0,y0,0,0));
-            }
-            else if((resizeEdges & Qt::TopEdge) && (resizeEdges & Qt::RightEdge))
-            {
-                window->setGeometry(origRect.adjusted(0,y0,x0,0));
-            }
-            else if((resizeEdges & Qt::BottomEdge) && (resizeEdges & Qt::RightEdge))
-            {
-                window->setGeometry(origRect.adjusted(0,0,x0,y0));
-
-            }
-            else if((resizeEdges & Qt::BottomEdge) && (resizeEdges & Qt::LeftEdge))
-            {
-                window->setGeometry(origRect.adjusted(x0,0,0,y0));
-            }
-            else if(resizeEdges & Qt::TopEdge)
-            {
-                window->setGeometry(origRect.adjusted(0,y0,0,0));
-            }
-            else if(resizeEdges & Qt::LeftEdge)
-            {
-                window->setGeometry(origRect.adjusted(x0,0,0,0));
-            }
-            else if(resizeEdges & Qt::BottomEdge)
-            {
-                window->setGeometry(origRect.adjusted(0,0,0,y0));
-            }
-            else if(resizeEdges & Qt::RightEdge)
-            {
-                window->setGeometry(origRect.adjusted(0,0,x0,0));
+        }
+        if(!interaction.resizeGlobalPos.isNull())
+        {
+            handled = true;
+            // All the constraints are applied in one go, so that the window
+            // manager (or the application) has nothing left to correct.
+            const QRect newGeometry = Utilities::calculateResizeGeometry(interaction.origRect, interaction.resizeEdges,
+                (globalMousePos - interaction.resizeGlobalPos), interaction.resizeConstraints);
+            // Once a limit has been reached the same geometry keeps coming
+            // out, there's no need to ask the window manager again.
+            if (newGeometry != currentGeometry()) {
+                transitionTo(WindowInteraction::State::Resizing);
+                trackGeometry(newGeometry, false);
+            } else if (statistics) {
+                ++statistics->commitsCoalesced;
             }
         }
 
     } else if (type == QEvent::MouseButtonPress) {
         if (edges != Qt::Edges{}) {
-            if ((window->windowState() == Qt::WindowState::WindowNoState) && !hitTestVisible && resizable) {
-                resizeGlobalPos = mouseEvent->globalPos();
-                origRect = window->geometry();
-                resizeEdges = edges;
+            if (statistics && (window->windowState() == Qt::WindowState::WindowNoState) && resizable) {
+                ++statistics->hitTests;
+            }
+            if ((window->windowState() == Qt::WindowState::WindowNoState) && resizable) {
+                if (Utilities::isHitTestVisible(hitTestVisibleObjects, globalMousePos)) {
+                    FramelessFlightRecorder::recordHitTest(window, localMousePosition, "HitTestVisible");
+                    FRAMELESSHELPER_TRACE(hitTest, window, localMousePosition.x(), localMousePosition.y(), "HitTestVisible");
+                } else {
+                    FramelessFlightRecorder::recordHitTest(window, localMousePosition, edgesLabel(edges));
+                    FRAMELESSHELPER_TRACE(hitTest, window, localMousePosition.x(), localMousePosition.y(), edgesLabel(edges));
+                    interaction.resizeEdges = edges;
+                    handled = true;
+                    if (systemMoveResize && startSystemMoveResize(edges)) {
+                        g_framelessHelperData()->systemMoveResizeWindow = window;
+                        transitionTo(WindowInteraction::State::Resizing);
+                    } else {
+                        interaction.resizeGlobalPos = globalMousePos;
+                        interaction.origRect = window->geometry();
+                        // Collected once, not for every mouse move.
+                        interaction.resizeConstraints = Utilities::windowGeometryConstraints(window);
+                    }
+                }
             }
         }
     }
     if(type == QEvent::MouseButtonRelease)
     {
-        resizeGlobalPos = QPoint();
-        origRect = QRect();
-        resizeEdges = Qt::Edges{};
+        QRect outlineGeometry = {};
+        const bool outlineShown = LiveResize::hideOutline(window, &outlineGeometry);
+        if (interaction.snapZone != ScreenIndex::SnapZone::None) {
+            LiveResize::hideSnapPreview(window);
+            // Let the window manager maximize the window, it knows better
+            // (and remembers the geometry to restore).
+            if (interaction.snapZone == ScreenIndex::SnapZone::Maximize) {
+                window->setWindowState(Qt::WindowState::WindowMaximized);
+            } else {
+                commitGeometry(interaction.snapGeometry, false);
+            }
+            interaction.snapZone = ScreenIndex::SnapZone::None;
+            interaction.snapGeometry = QRect();
+        } else if (outlineShown && (outlineGeometry != window->geometry())) {
+            commitGeometry(outlineGeometry, (outlineGeometry.size() == window->size()));
+        }
+        transitionTo(WindowInteraction::State::Idle);
+        // The press which started the resize hasn't been delivered either.
+        handled = (interaction.resizeEdges != Qt::Edges{});
+        interaction.freeGeometry = QRect();
+        interaction.magnetismIgnored.clear();
+        interaction.resizeGlobalPos = QPoint();
+        interaction.origRect = QRect();
+        interaction.resizeEdges = Qt::Edges{};
     }
-    return false;
+    // Hit test visible controls never get here with "handled" set, they
+    // still receive everything.
+    const bool consumed = (consumeMouseEvents && handled);
+    FRAMELESSHELPER_TRACE(eventFilter_exit, window, consumed);
+    return consumed;
 }
 
 FRAMELESSHELPER_END_NAMESPACE
@@ -111,6 +111,11 @@ namespace Constants
 [[maybe_unused]] constexpr char kTitleBarHeightFlag[] = "_FRAMELESSHELPER_TITLE_BAR_HEIGHT";
 [[maybe_unused]] constexpr char kHitTestVisibleFlag[] = "_FRAMELESSHELPER_HIT_TEST_VISIBLE";
 [[maybe_unused]] constexpr char kWindowFixedSizeFlag[] = "_FRAMELESSHELPER_WINDOW_FIXED_SIZE";
+[[maybe_unused]] constexpr char kMoveResizeModeFlag[] = "_FRAMELESSHELPER_MOVE_RESIZE_MODE";
+[[maybe_unused]] constexpr char kLiveResizeModeFlag[] = "_FRAMELESSHELPER_LIVE_RESIZE_MODE";
+[[maybe_unused]] constexpr char kAspectRatioFlag[] = "_FRAMELESSHELPER_ASPECT_RATIO";
+[[maybe_unused]] constexpr char kEdgeSnappingFlag[] = "_FRAMELESSHELPER_EDGE_SNAPPING";
+[[maybe_unused]] constexpr char kConsumeMouseEventsFlag[] = "_FRAMELESSHELPER_CONSUME_MOUSE_EVENTS";
 
 }
 
@@ -131,4 +136,22 @@ enum class ColorizationArea : int
 };
 Q_ENUM_NS(ColorizationArea)
 
+enum class MoveResizeMode : int
+{
+    Manual = 0, // Move and resize the window ourself, one geometry change per mouse move.
+    System      // Hand the whole interaction over to the window manager (Qt 5.15+).
+};
+Q_ENUM_NS(MoveResizeMode)
+
+enum class LiveResizeMode : int
+{
+    Default = 0,       // Repaint and relayout at every intermediate size.
+    StaticContents,    // Widget windows: only paint the exposed strips, relayout once at the end.
+    SnapshotStretched, // Show a snapshot taken when the resize started, scaled to the window size.
+    SnapshotAnchored,  // Same, but unscaled and anchored to the edges which don't move.
+    Outline            // Only move/resize an outline, the window follows once on release.
+                       // Applies to moves as well, MoveResizeMode::Manual only.
+};
+Q_ENUM_NS(LiveResizeMode)
+
 FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,37 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+// The tracepoints are declared in framelesshelper.tracepoints and turned into
+// LTTng (Linux) or ETW (Windows) providers by Qt's tracegen. Without tracing
+// support FRAMELESSHELPER_TRACE() expands to nothing, arguments included.
+#ifdef FRAMELESSHELPER_HAS_TRACEPOINTS
+#include "framelesshelper_tracepoints_p.h"
+#define FRAMELESSHELPER_TRACE(name, ...) QT_PREPEND_NAMESPACE(QtPrivate)::trace_framelesshelper_##name(__VA_ARGS__)
+#else
+#define FRAMELESSHELPER_TRACE(name, ...)
+#endif
@@ -30,9 +30,64 @@
 #include <QtGui/qwindow.h>
 #include "utilities.h"
 #include "framelesshelper_windows.h"
+#include "framelessflightrecorder_p.h"
+#include "framelesswindowsmanager_p.h"
+#include "framelesshelper_trace_p.h"
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
+[[nodiscard]] static inline const char *hitTestLabel(const LRESULT value)
+{
+    switch (value) {
+    case HTCAPTION:
+        return "TitleBar";
+    case HTTOPLEFT:
+        return "TopLeft";
+    case HTTOPRIGHT:
+        return "TopRight";
+    case HTBOTTOMLEFT:
+        return "BottomLeft";
+    case HTBOTTOMRIGHT:
+        return "BottomRight";
+    case HTTOP:
+        return "Top";
+    case HTBOTTOM:
+        return "Bottom";
+    case HTLEFT:
+        return "Left";
+    case HTRIGHT:
+        return "Right";
+    default:
+        break;
+    }
+    return "Client";
+}
+
+[[nodiscard]] static inline Qt::Edges sizingEdges(const WPARAM value)
+{
+    switch (value) {
+    case WMSZ_LEFT:
+        return Qt::LeftEdge;
+    case WMSZ_RIGHT:
+        return Qt::RightEdge;
+    case WMSZ_TOP:
+        return Qt::TopEdge;
+    case WMSZ_TOPLEFT:
+        return (Qt::TopEdge | Qt::LeftEdge);
+    case WMSZ_TOPRIGHT:
+        return (Qt::TopEdge | Qt::RightEdge);
+    case WMSZ_BOTTOM:
+        return Qt::BottomEdge;
+    case WMSZ_BOTTOMLEFT:
+        return (Qt::BottomEdge | Qt::LeftEdge);
+    case WMSZ_BOTTOMRIGHT:
+        return (Qt::BottomEdge | Qt::RightEdge);
+    default:
+        break;
+    }
+    return {};
+}
+
 struct FramelessHelperWinData
 {
     [[nodiscard]] bool create() {
@@ -632,6 +687,8 @@ bool FramelessHelperWin::nativeEventFilter(const QByteArray &eventType, void *me
             }
             return HTCLIENT;
         }();
+        FramelessFlightRecorder::recordHitTest(window, localMouse.toPoint(), hitTestLabel(*result));
+        FRAMELESSHELPER_TRACE(hitTest, window, winLocalMouse.x, winLocalMouse.y, hitTestLabel(*result));
         return true;
     }
     case WM_SETICON:
@@ -663,6 +720,17 @@ bool FramelessHelperWin::nativeEventFilter(const QByteArray &eventType, void *me
         *result = ret;
         return true;
     }
+    // The modal move/size loop of Windows only tells us what it's doing once
+    // the window actually starts moving (WM_MOVING) or resizing (WM_SIZING).
+    case WM_MOVING:
+        WindowInteraction::setState(const_cast<QWindow *>(window), WindowInteraction::State::Moving);
+        break;
+    case WM_SIZING:
+        WindowInteraction::setState(const_cast<QWindow *>(window), WindowInteraction::State::Resizing, sizingEdges(msg->wParam));
+        break;
+    case WM_EXITSIZEMOVE:
+        WindowInteraction::setState(const_cast<QWindow *>(window), WindowInteraction::State::Idle);
+        break;
 #if (QT_VERSION < QT_VERSION_CHECK(6, 2, 2))
     case WM_WINDOWPOSCHANGING: {
         // Tell Windows to discard the entire contents of the client area, as re-using
@@ -0,0 +1,266 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessinputrecorder.h"
+#include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qwindow.h>
+#include <atomic>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+static constexpr quint32 kRecordingMagic = 0x52494846; // "FHIR"
+static constexpr quint32 kRecordingVersion = 1;
+
+struct InputRecord
+{
+    quint16 type = 0;
+    quint16 windowState = 0;
+    quint32 button = 0;
+    quint32 buttons = 0;
+    quint64 timestamp = 0;
+    float localX = 0.0f;
+    float localY = 0.0f;
+    float globalX = 0.0f;
+    float globalY = 0.0f;
+    qint32 windowX = 0;
+    qint32 windowY = 0;
+    qint32 windowWidth = 0;
+    qint32 windowHeight = 0;
+};
+
+static inline QDataStream &operator<<(QDataStream &stream, const InputRecord &record)
+{
+    stream << record.type << record.windowState << record.button << record.buttons << record.timestamp
+           << record.localX << record.localY << record.globalX << record.globalY
+           << record.windowX << record.windowY << record.windowWidth << record.windowHeight;
+    return stream;
+}
+
+static inline QDataStream &operator>>(QDataStream &stream, InputRecord &record)
+{
+    stream >> record.type >> record.windowState >> record.button >> record.buttons >> record.timestamp
+           >> record.localX >> record.localY >> record.globalX >> record.globalY
+           >> record.windowX >> record.windowY >> record.windowWidth >> record.windowHeight;
+    return stream;
+}
+
+[[nodiscard]] static inline quint16 packWindowState(const Qt::WindowStates states)
+{
+    if (states & Qt::WindowFullScreen) {
+        return 3;
+    }
+    if (states & Qt::WindowMaximized) {
+        return 2;
+    }
+    if (states & Qt::WindowMinimized) {
+        return 1;
+    }
+    return 0;
+}
+
+[[nodiscard]] static inline Qt::WindowState unpackWindowState(const quint16 state)
+{
+    switch (state) {
+    case 1:
+        return Qt::WindowMinimized;
+    case 2:
+        return Qt::WindowMaximized;
+    case 3:
+        return Qt::WindowFullScreen;
+    default:
+        break;
+    }
+    return Qt::WindowNoState;
+}
+
+struct Recording
+{
+    QFile file;
+    QDataStream stream;
+    QMetaObject::Connection destroyedConnection = {};
+};
+
+struct FramelessInputRecorderData
+{
+    QHash<const QWindow *, QSharedPointer<Recording>> recordings = {};
+};
+
+Q_GLOBAL_STATIC(FramelessInputRecorderData, g_framelessInputRecorderData)
+
+// Keeps the check on the event path down to a single load while nothing is being recorded.
+static std::atomic_int g_activeRecordings = {0};
+
+static inline void setupStream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+bool FramelessInputRecorder::startRecording(QWindow *window, const QString &filePath)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(!filePath.isEmpty());
+    if (!window || filePath.isEmpty()) {
+        return false;
+    }
+    stopRecording(window);
+    const auto recording = QSharedPointer<Recording>::create();
+    recording->file.setFileName(filePath);
+    if (!recording->file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "Failed to open" << filePath << "for recording:" << recording->file.errorString();
+        return false;
+    }
+    recording->stream.setDevice(&recording->file);
+    setupStream(recording->stream);
+    recording->stream << kRecordingMagic << kRecordingVersion;
+    // Finish the file and forget about the window once it's gone.
+    recording->destroyedConnection = QObject::connect(window, &QObject::destroyed, [window](){
+        stopRecording(window);
+    });
+    g_framelessInputRecorderData()->recordings.insert(window, recording);
+    ++g_activeRecordings;
+    return true;
+}
+
+void FramelessInputRecorder::stopRecording(QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    const QSharedPointer<Recording> recording = g_framelessInputRecorderData()->recordings.take(window);
+    if (recording.isNull()) {
+        return;
+    }
+    --g_activeRecordings;
+    QObject::disconnect(recording->destroyedConnection);
+    recording->file.close();
+}
+
+bool FramelessInputRecorder::isRecording(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window || (g_activeRecordings.load(std::memory_order_relaxed) <= 0)) {
+        return false;
+    }
+    return g_framelessInputRecorderData()->recordings.contains(window);
+}
+
+void FramelessInputRecorder::recordEvent(const QWindow *window, const QMouseEvent *event)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(event);
+    if (!window || !event || (g_activeRecordings.load(std::memory_order_relaxed) <= 0)) {
+        return;
+    }
+    const QSharedPointer<Recording> recording = g_framelessInputRecorderData()->recordings.value(window);
+    if (recording.isNull()) {
+        return;
+    }
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    const QPointF localPos = event->position();
+    const QPointF globalPos = event->globalPosition();
+#else
+    const QPointF localPos = event->windowPos();
+    const QPointF globalPos = event->screenPos();
+#endif
+    const QRect geometry = window->geometry();
+    InputRecord record = {};
+    record.type = static_cast<quint16>(event->type());
+    record.button = static_cast<quint32>(event->button());
+    record.windowState = packWindowState(window->windowStates());
+    record.buttons = static_cast<quint32>(event->buttons());
+    record.timestamp = static_cast<quint64>(event->timestamp());
+    record.localX = static_cast<float>(localPos.x());
+    record.localY = static_cast<float>(localPos.y());
+    record.globalX = static_cast<float>(globalPos.x());
+    record.globalY = static_cast<float>(globalPos.y());
+    record.windowX = geometry.x();
+    record.windowY = geometry.y();
+    record.windowWidth = geometry.width();
+    record.windowHeight = geometry.height();
+    recording->stream << record;
+}
+
+QList<QRect> FramelessInputRecorder::replay(QWindow *window, const QString &filePath)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(!filePath.isEmpty());
+    if (!window || filePath.isEmpty()) {
+        return {};
+    }
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly)) {
+        qWarning() << "Failed to open" << filePath << "for replaying:" << file.errorString();
+        return {};
+    }
+    QDataStream stream(&file);
+    setupStream(stream);
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if ((magic != kRecordingMagic) || (version != kRecordingVersion)) {
+        qWarning() << filePath << "is not a FramelessHelper input recording.";
+        return {};
+    }
+    QList<QRect> geometries = {};
+    bool first = true;
+    while (!stream.atEnd()) {
+        InputRecord record = {};
+        stream >> record;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << filePath << "is truncated.";
+            break;
+        }
+        if (first) {
+            // Start from the same place as the capture did, everything after
+            // that is up to the library.
+            first = false;
+            window->setWindowState(unpackWindowState(record.windowState));
+            if (record.windowState == 0) {
+                window->setGeometry(record.windowX, record.windowY, record.windowWidth, record.windowHeight);
+            }
+        }
+        // The global position is what drives the interaction, the local one is
+        // derived from wherever the window is now, which may differ from the
+        // capture if the library behaves differently.
+        const QPointF globalPos = {record.globalX, record.globalY};
+        const QPointF localPos = (globalPos - window->position());
+        QMouseEvent event(static_cast<QEvent::Type>(record.type), localPos, localPos, globalPos,
+                          static_cast<Qt::MouseButton>(record.button),
+                          Qt::MouseButtons(QFlag(static_cast<int>(record.buttons))), Qt::NoModifier);
+        event.setTimestamp(record.timestamp);
+        QCoreApplication::sendEvent(window, &event);
+        geometries.append(window->geometry());
+    }
+    return geometries;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
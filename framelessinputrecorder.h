@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qlist.h>
+#include <QtCore/qrect.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_FORWARD_DECLARE_CLASS(QMouseEvent)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Records the mouse events seen by FramelessHelper (together with the window
+// geometry and state at that time) into a compact binary file, and replays
+// such a file to a window with a virtual clock: the events are delivered back
+// to back with their recorded timestamps. The geometry sequences produced by
+// replaying the same capture with different library versions can be diffed.
+namespace FramelessInputRecorder
+{
+
+[[nodiscard]] FRAMELESSHELPER_API bool startRecording(QWindow *window, const QString &filePath);
+FRAMELESSHELPER_API void stopRecording(QWindow *window);
+[[nodiscard]] FRAMELESSHELPER_API bool isRecording(const QWindow *window);
+[[nodiscard]] FRAMELESSHELPER_API QList<QRect> replay(QWindow *window, const QString &filePath);
+
+// Called by FramelessHelper for every mouse event it filters.
+FRAMELESSHELPER_API void recordEvent(const QWindow *window, const QMouseEvent *event);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
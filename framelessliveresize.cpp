@@ -0,0 +1,438 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessliveresize_p.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpixmap.h>
+#include <QtGui/qregion.h>
+#include <QtGui/qscreen.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qrasterwindow.h>
+#include <QtGui/qwindow.h>
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qlayout.h>
+#include <QtWidgets/qwidget.h>
+#endif
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace LiveResize
+{
+
+// A native child window covering the whole frameless window, which shows the
+// snapshot instead of the real content until the resize has finished.
+class SnapshotWindow : public QRasterWindow
+{
+    Q_DISABLE_COPY_MOVE(SnapshotWindow)
+
+public:
+    explicit SnapshotWindow(QWindow *window, const QPixmap &snapshot, const bool stretched, const Qt::Edges edges)
+        : QRasterWindow(window), m_snapshot(snapshot), m_stretched(stretched), m_edges(edges)
+    {
+        Q_ASSERT(window);
+        setFlags(flags() | Qt::WindowTransparentForInput);
+        setGeometry(0, 0, window->width(), window->height());
+        window->installEventFilter(this);
+    }
+
+    ~SnapshotWindow() override = default;
+
+    // The resize is over: the snapshot goes away as soon as the real content
+    // has been drawn at the final size, so that nothing flickers in between.
+    void finish()
+    {
+        m_finished = true;
+        // There may never be another frame, if the window isn't exposed.
+        QTimer::singleShot(kFinishTimeout, this, &QObject::deleteLater);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        Q_UNUSED(event);
+        QPainter painter(this);
+        const QRect rect = {0, 0, width(), height()};
+        if (m_stretched) {
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+            painter.drawPixmap(rect, m_snapshot);
+            return;
+        }
+        painter.fillRect(rect, QGuiApplication::palette().window());
+        // Keep the snapshot where it was on screen: glued to the edges which
+        // are not being dragged.
+        const QSize snapshotSize = (QSizeF(m_snapshot.size()) / m_snapshot.devicePixelRatio()).toSize();
+        const int x = ((m_edges & Qt::LeftEdge) ? (width() - snapshotSize.width()) : 0);
+        const int y = ((m_edges & Qt::TopEdge) ? (height() - snapshotSize.height()) : 0);
+        painter.drawPixmap(QPoint(x, y), m_snapshot);
+    }
+
+    bool eventFilter(QObject *object, QEvent *event) override
+    {
+        if (object != parent()) {
+            return false;
+        }
+        switch (event->type()) {
+        case QEvent::Resize:
+            if (!m_finished) {
+                resize(static_cast<QResizeEvent *>(event)->size());
+                update();
+            }
+            break;
+        case QEvent::Expose:
+        case QEvent::UpdateRequest:
+            // The window draws its content while this event is being
+            // delivered, which is over by the time the deferred deletion runs.
+            if (m_finished && static_cast<QWindow *>(object)->isExposed()) {
+                deleteLater();
+            }
+            break;
+        default:
+            break;
+        }
+        return false;
+    }
+
+private:
+    static constexpr int kFinishTimeout = 500;
+
+    QPixmap m_snapshot = {};
+    bool m_stretched = true;
+    Qt::Edges m_edges = {};
+    bool m_finished = false;
+};
+
+// A top level window which only consists of a thin frame: everything else is
+// masked out, so it needs neither a compositor nor any repainting of what's
+// underneath, which keeps it cheap on remote desktop sessions as well.
+class OutlineWindow : public QRasterWindow
+{
+    Q_DISABLE_COPY_MOVE(OutlineWindow)
+
+public:
+    explicit OutlineWindow() : QRasterWindow()
+    {
+        setFlags(Qt::ToolTip | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint
+                 | Qt::WindowTransparentForInput | Qt::WindowDoesNotAcceptFocus);
+    }
+
+    ~OutlineWindow() override = default;
+
+    void setOutlineGeometry(const QRect &rect)
+    {
+        if (rect == geometry()) {
+            return;
+        }
+        const bool sizeChanged = (rect.size() != size());
+        setGeometry(rect);
+        if (sizeChanged) {
+            const QRect outer = {0, 0, rect.width(), rect.height()};
+            setMask(QRegion(outer).subtracted(QRegion(outer.adjusted(kThickness, kThickness, -kThickness, -kThickness))));
+        }
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        Q_UNUSED(event);
+        QPainter painter(this);
+        painter.fillRect(QRect(0, 0, width(), height()), QGuiApplication::palette().highlight());
+    }
+
+private:
+    static constexpr int kThickness = 3;
+};
+
+struct OutlineData
+{
+    QScopedPointer<OutlineWindow> window;
+    const QWindow *owner = nullptr;
+};
+
+Q_GLOBAL_STATIC(OutlineData, g_outlineData)
+Q_GLOBAL_STATIC(OutlineData, g_snapPreviewData)
+
+struct LiveResizeState
+{
+    LiveResizeMode mode = LiveResizeMode::Default;
+    QPointer<SnapshotWindow> snapshotWindow = nullptr;
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+    QPointer<QWidget> widget = nullptr;
+    bool hadStaticContents = false;
+    bool updatesWereEnabled = true;
+    bool layoutWasEnabled = false;
+#endif
+};
+
+struct LiveResizeData
+{
+    QHash<const QWindow *, LiveResizeState> states = {};
+};
+
+Q_GLOBAL_STATIC(LiveResizeData, g_liveResizeData)
+
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+[[nodiscard]] static inline QWidget *findWidget(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window || !qobject_cast<QApplication *>(QCoreApplication::instance())) {
+        return nullptr;
+    }
+    const QWidgetList widgets = QApplication::topLevelWidgets();
+    for (auto &&widget : qAsConst(widgets)) {
+        if (widget && (widget->windowHandle() == window)) {
+            return widget;
+        }
+    }
+    return nullptr;
+}
+
+// With the layout disabled the children keep their geometry instead of being
+// laid out again for every intermediate size.
+static inline void freezeLayout(QWidget *widget, LiveResizeState *state)
+{
+    Q_ASSERT(widget);
+    Q_ASSERT(state);
+    if (!widget || !state) {
+        return;
+    }
+    state->widget = widget;
+    if (QLayout * const layout = widget->layout()) {
+        state->layoutWasEnabled = layout->isEnabled();
+        layout->setEnabled(false);
+    }
+}
+
+static inline void unfreezeLayout(QWidget *widget, const LiveResizeState &state)
+{
+    Q_ASSERT(widget);
+    if (!widget) {
+        return;
+    }
+    if (QLayout * const layout = widget->layout()) {
+        layout->setEnabled(state.layoutWasEnabled);
+        layout->invalidate();
+        layout->activate();
+    }
+}
+#endif
+
+[[nodiscard]] static inline QPixmap grabWindow(QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+    if (QWidget * const widget = findWidget(window)) {
+        return widget->grab();
+    }
+#endif
+    QScreen * const screen = window->screen();
+    if (!screen) {
+        return {};
+    }
+    return screen->grabWindow(window->winId());
+}
+
+void begin(QWindow *window, const Qt::Edges edges)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    LiveResizeState state = {};
+    state.mode = static_cast<LiveResizeMode>(window->property(Constants::kLiveResizeModeFlag).toInt());
+    switch (state.mode) {
+    case LiveResizeMode::Default:
+    case LiveResizeMode::Outline: // Driven by FramelessHelper itself.
+        return;
+    case LiveResizeMode::StaticContents: {
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+        QWidget * const widget = findWidget(window);
+        if (!widget) {
+            return;
+        }
+        // Only the newly exposed strips get painted while the attribute is set.
+        state.hadStaticContents = widget->testAttribute(Qt::WA_StaticContents);
+        widget->setAttribute(Qt::WA_StaticContents);
+        freezeLayout(widget, &state);
+#else
+        // Only widget windows can be frozen.
+        return;
+#endif
+    } break;
+    case LiveResizeMode::SnapshotStretched:
+    case LiveResizeMode::SnapshotAnchored: {
+        const QPixmap snapshot = grabWindow(window);
+        if (snapshot.isNull()) {
+            // Grabbing isn't possible everywhere (Wayland), resize live instead.
+            return;
+        }
+        state.snapshotWindow = new SnapshotWindow(window, snapshot,
+            (state.mode == LiveResizeMode::SnapshotStretched), edges);
+        state.snapshotWindow->show();
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+        // The real content is hidden anyway, don't spend any time on it.
+        if (QWidget * const widget = findWidget(window)) {
+            state.updatesWereEnabled = widget->updatesEnabled();
+            widget->setUpdatesEnabled(false);
+            freezeLayout(widget, &state);
+        }
+#endif
+    } break;
+    }
+    g_liveResizeData()->states.insert(window, state);
+}
+
+void end(QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    const auto it = g_liveResizeData()->states.find(window);
+    if (it == g_liveResizeData()->states.end()) {
+        return;
+    }
+    const LiveResizeState state = it.value();
+    g_liveResizeData()->states.erase(it);
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+    QWidget * const widget = state.widget;
+#endif
+    switch (state.mode) {
+    case LiveResizeMode::Default:
+    case LiveResizeMode::Outline:
+        break;
+    case LiveResizeMode::StaticContents: {
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+        if (!widget) {
+            break;
+        }
+        widget->setAttribute(Qt::WA_StaticContents, state.hadStaticContents);
+        unfreezeLayout(widget, state);
+        // One full repaint at the final size.
+        widget->update();
+#endif
+    } break;
+    case LiveResizeMode::SnapshotStretched:
+    case LiveResizeMode::SnapshotAnchored: {
+#ifdef FRAMELESSHELPER_HAS_WIDGETS
+        if (widget) {
+            unfreezeLayout(widget, state);
+            widget->setUpdatesEnabled(state.updatesWereEnabled);
+            widget->update();
+        }
+#endif
+        // Keep the snapshot on top until the real content has been painted.
+        if (state.snapshotWindow) {
+            state.snapshotWindow->finish();
+        }
+    } break;
+    }
+}
+
+static void showOutlineWindow(OutlineData *data, QWindow *window, const QRect &geometry)
+{
+    Q_ASSERT(data);
+    Q_ASSERT(window);
+    if (!data || !window || !geometry.isValid()) {
+        return;
+    }
+    // Only one window can be dragged at a time, so one outline is enough.
+    if (data->window.isNull()) {
+        data->window.reset(new OutlineWindow);
+    }
+    data->owner = window;
+    data->window->setScreen(window->screen());
+    data->window->setOutlineGeometry(geometry);
+    if (!data->window->isVisible()) {
+        data->window->show();
+    }
+}
+
+void showOutline(QWindow *window, const QRect &geometry)
+{
+    showOutlineWindow(g_outlineData(), window, geometry);
+}
+
+QRect outlineGeometry(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+    const OutlineData * const data = g_outlineData();
+    if (data->window.isNull() || (data->owner != window) || !data->window->isVisible()) {
+        return {};
+    }
+    return data->window->geometry();
+}
+
+bool hideOutline(const QWindow *window, QRect *geometry)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(geometry);
+    if (!window || !geometry) {
+        return false;
+    }
+    const QRect rect = outlineGeometry(window);
+    if (!rect.isValid()) {
+        return false;
+    }
+    OutlineData * const data = g_outlineData();
+    data->window.reset();
+    data->owner = nullptr;
+    *geometry = rect;
+    return true;
+}
+
+void showSnapPreview(QWindow *window, const QRect &geometry)
+{
+    showOutlineWindow(g_snapPreviewData(), window, geometry);
+}
+
+void hideSnapPreview(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    OutlineData * const data = g_snapPreviewData();
+    if (data->owner != window) {
+        return;
+    }
+    data->window.reset();
+    data->owner = nullptr;
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
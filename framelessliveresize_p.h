@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+#include <QtCore/qrect.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Applies the LiveResizeMode of a window for the duration of an interactive
+// resize. Called by WindowInteraction::setState().
+namespace LiveResize
+{
+
+void begin(QWindow *window, const Qt::Edges edges);
+void end(QWindow *window);
+
+// LiveResizeMode::Outline: shows (or moves) the outline of "window" at "geometry".
+void showOutline(QWindow *window, const QRect &geometry);
+// Returns a null rect if no outline is shown.
+[[nodiscard]] QRect outlineGeometry(const QWindow *window);
+// Hides the outline and returns the geometry it was showing last.
+[[nodiscard]] bool hideOutline(const QWindow *window, QRect *geometry);
+
+// Edge snapping: previews the geometry "window" gets when dropped, an outline as well.
+void showSnapPreview(QWindow *window, const QRect &geometry);
+void hideSnapPreview(const QWindow *window);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,330 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessmagnetism_p.h"
+#include "framelessscreenindex_p.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qwindow.h>
+#include <algorithm>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace WindowMagnetism
+{
+
+static constexpr int kDefaultDistance = 10;
+
+// One side of a window: its position is the key in the index, "from" and
+// "to" are where it starts and ends along the other axis (end exclusive).
+struct Edge
+{
+    const QWindow *window = nullptr;
+    int from = 0;
+    int to = 0;
+};
+
+// All the edges at one position, sorted by "from". "reach" holds the largest
+// "to" of the edges up to each one, it never decreases, so the edges which
+// may overlap a range are found with two binary searches.
+struct EdgeList
+{
+    QVector<Edge> edges = {};
+    QVector<int> reach = {};
+};
+
+using EdgeIndex = QMap<int, EdgeList>;
+
+struct MagnetismData
+{
+    bool enabled = false;
+    int distance = kDefaultDistance;
+    // Left and right edges keyed by x, top and bottom edges keyed by y. The
+    // right and bottom edges are exclusive, so that a window sticking to them
+    // ends up next to the other window rather than on top of its last pixel.
+    EdgeIndex verticalEdges = {};
+    EdgeIndex horizontalEdges = {};
+    // What is in the indexes for each window, to find its edges again.
+    QHash<const QWindow *, QRect> geometries = {};
+};
+
+Q_GLOBAL_STATIC(MagnetismData, g_magnetismData)
+
+static void updateReach(EdgeList *list, const int first)
+{
+    Q_ASSERT(list);
+    if (!list) {
+        return;
+    }
+    list->reach.resize(list->edges.size());
+    for (int i = first; i < list->edges.size(); ++i) {
+        const int to = list->edges.at(i).to;
+        list->reach[i] = ((i > 0) ? qMax(list->reach.at(i - 1), to) : to);
+    }
+}
+
+static void insertEdge(EdgeIndex *edges, const int position, const Edge &edge)
+{
+    Q_ASSERT(edges);
+    if (!edges) {
+        return;
+    }
+    EdgeList &list = (*edges)[position];
+    const auto it = std::upper_bound(list.edges.begin(), list.edges.end(), edge.from,
+        [](const int from, const Edge &other){ return (from < other.from); });
+    const int index = static_cast<int>(it - list.edges.begin());
+    list.edges.insert(index, edge);
+    updateReach(&list, index);
+}
+
+static void removeEdge(EdgeIndex *edges, const int position, const QWindow *window)
+{
+    Q_ASSERT(edges);
+    Q_ASSERT(window);
+    if (!edges || !window) {
+        return;
+    }
+    const auto it = edges->find(position);
+    if (it == edges->end()) {
+        return;
+    }
+    EdgeList &list = it.value();
+    for (int i = 0; i != list.edges.size(); ++i) {
+        if (list.edges.at(i).window == window) {
+            list.edges.removeAt(i);
+            if (list.edges.isEmpty()) {
+                edges->erase(it);
+            } else {
+                updateReach(&list, i);
+            }
+            return;
+        }
+    }
+}
+
+static void removeEdges(MagnetismData *data, const QWindow *window, const QRect &geometry)
+{
+    Q_ASSERT(data);
+    Q_ASSERT(window);
+    if (!data || !window) {
+        return;
+    }
+    removeEdge(&data->verticalEdges, geometry.left(), window);
+    removeEdge(&data->verticalEdges, (geometry.right() + 1), window);
+    removeEdge(&data->horizontalEdges, geometry.top(), window);
+    removeEdge(&data->horizontalEdges, (geometry.bottom() + 1), window);
+}
+
+static void insertEdges(MagnetismData *data, const QWindow *window, const QRect &geometry)
+{
+    Q_ASSERT(data);
+    Q_ASSERT(window);
+    if (!data || !window) {
+        return;
+    }
+    const Edge vertical = {window, geometry.top(), (geometry.bottom() + 1)};
+    insertEdge(&data->verticalEdges, geometry.left(), vertical);
+    insertEdge(&data->verticalEdges, (geometry.right() + 1), vertical);
+    const Edge horizontal = {window, geometry.left(), (geometry.right() + 1)};
+    insertEdge(&data->horizontalEdges, geometry.top(), horizontal);
+    insertEdge(&data->horizontalEdges, (geometry.bottom() + 1), horizontal);
+}
+
+// Whether any edge of "list" other than the ones of "window" and "ignored"
+// overlaps [from, to).
+// Only the edges between the first one reaching past "from" and the first one
+// starting at or after "to" are looked at. Side by side windows don't overlap
+// each other, so those are the edges which actually overlap the range.
+[[nodiscard]] static bool hasOverlappingEdge(const EdgeList &list, const QWindow *window,
+                                             const QWindowList &ignored, const int from, const int to)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return false;
+    }
+    const int first = static_cast<int>(std::upper_bound(list.reach.cbegin(), list.reach.cend(), from)
+                                       - list.reach.cbegin());
+    const int last = static_cast<int>(std::lower_bound(list.edges.cbegin(), list.edges.cend(), to,
+        [](const Edge &edge, const int value){ return (edge.from < value); }) - list.edges.cbegin());
+    for (int i = first; i < last; ++i) {
+        const Edge &edge = list.edges.at(i);
+        if ((edge.to > from) && (edge.window != window)
+                && !ignored.contains(const_cast<QWindow *>(edge.window))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Looks for the edge closest to "position" among the ones within reach which
+// overlap [from, to), and keeps the offset to it in "best" if it's closer.
+// There are at most (2 * distance + 1) positions to look at, however many
+// windows share them.
+static void findClosestEdge(const EdgeIndex &edges, const QWindow *window, const QWindowList &ignored,
+                            const int position, const int from, const int to, const int distance, int *best)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(best);
+    if (!window || !best) {
+        return;
+    }
+    for (auto it = edges.lowerBound(position - distance); (it != edges.cend()) && (it.key() <= (position + distance)); ++it) {
+        const int offset = (it.key() - position);
+        if ((qAbs(offset) < qAbs(*best)) && hasOverlappingEdge(it.value(), window, ignored, from, to)) {
+            *best = offset;
+        }
+    }
+}
+
+static inline void keepClosest(const int offset, const int distance, int *best)
+{
+    Q_ASSERT(best);
+    if (!best) {
+        return;
+    }
+    if ((qAbs(offset) <= distance) && (qAbs(offset) < qAbs(*best))) {
+        *best = offset;
+    }
+}
+
+void setEnabled(const bool value)
+{
+    MagnetismData * const data = g_magnetismData();
+    if (data->enabled == value) {
+        return;
+    }
+    data->enabled = value;
+    data->verticalEdges.clear();
+    data->horizontalEdges.clear();
+    data->geometries.clear();
+    if (!value) {
+        return;
+    }
+    const QWindowList windows = QGuiApplication::topLevelWindows();
+    for (auto &&window : qAsConst(windows)) {
+        if (window && window->property(Constants::kFramelessModeFlag).toBool()) {
+            update(window);
+        }
+    }
+}
+
+bool isEnabled()
+{
+    return g_magnetismData()->enabled;
+}
+
+void setDistance(const int value)
+{
+    g_magnetismData()->distance = qMax(value, 0);
+}
+
+int distance()
+{
+    return g_magnetismData()->distance;
+}
+
+void update(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    MagnetismData * const data = g_magnetismData();
+    if (!data->enabled) {
+        return;
+    }
+    if (!window->isVisible() || (window->windowState() == Qt::WindowMinimized)) {
+        remove(window);
+        return;
+    }
+    const QRect geometry = window->geometry();
+    const auto it = data->geometries.find(window);
+    if (it != data->geometries.end()) {
+        if (it.value() == geometry) {
+            return;
+        }
+        removeEdges(data, window, it.value());
+        it.value() = geometry;
+    } else {
+        data->geometries.insert(window, geometry);
+    }
+    insertEdges(data, window, geometry);
+}
+
+void remove(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    MagnetismData * const data = g_magnetismData();
+    const auto it = data->geometries.find(window);
+    if (it == data->geometries.end()) {
+        return;
+    }
+    removeEdges(data, window, it.value());
+    data->geometries.erase(it);
+}
+
+QRect snap(const QWindow *window, const QRect &geometry, const QWindowList &ignored)
+{
+    Q_ASSERT(window);
+    if (!window || !geometry.isValid()) {
+        return geometry;
+    }
+    const MagnetismData * const data = g_magnetismData();
+    if (!data->enabled || (data->distance <= 0)) {
+        return geometry;
+    }
+    const int distance = data->distance;
+    // Anything further away than "distance" never wins.
+    int dx = (distance + 1);
+    int dy = (distance + 1);
+    // Only the edges of the windows beside (or above and below) this one can
+    // be reached, the others are filtered out by their extent.
+    const int top = (geometry.top() - distance);
+    const int bottom = (geometry.bottom() + 1 + distance);
+    findClosestEdge(data->verticalEdges, window, ignored, geometry.left(), top, bottom, distance, &dx);
+    findClosestEdge(data->verticalEdges, window, ignored, (geometry.right() + 1), top, bottom, distance, &dx);
+    const int left = (geometry.left() - distance);
+    const int right = (geometry.right() + 1 + distance);
+    findClosestEdge(data->horizontalEdges, window, ignored, geometry.top(), left, right, distance, &dy);
+    findClosestEdge(data->horizontalEdges, window, ignored, (geometry.bottom() + 1), left, right, distance, &dy);
+    // The work area edges are magnetic as well.
+    const QRect area = ScreenIndex::availableGeometry(geometry.center());
+    if (area.isValid()) {
+        keepClosest((area.left() - geometry.left()), distance, &dx);
+        keepClosest((area.right() - geometry.right()), distance, &dx);
+        keepClosest((area.top() - geometry.top()), distance, &dy);
+        keepClosest((area.bottom() - geometry.bottom()), distance, &dy);
+    }
+    return geometry.translated(((qAbs(dx) <= distance) ? dx : 0), ((qAbs(dy) <= distance) ? dy : 0));
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
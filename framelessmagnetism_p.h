@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+#include <QtCore/qrect.h>
+#include <QtGui/qwindowdefs.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Winamp style edge magnetism between the frameless windows: a window which
+// is dragged close enough to the edge of another one (or of the work area)
+// sticks to it. The edges of all visible frameless windows are kept in two
+// indexes sorted by coordinate, updated one window at a time from the move
+// and resize events. The edges sharing a coordinate (windows lined up with
+// each other) are sorted by extent, so looking up the edges around a dragged
+// window is a binary search per coordinate within reach, rather than a walk
+// over every window lined up there. GUI thread only.
+namespace WindowMagnetism
+{
+
+// Disabled by default, nothing is indexed until it's enabled.
+void setEnabled(const bool value);
+[[nodiscard]] bool isEnabled();
+// How close (in pixels) two edges have to get to stick together.
+void setDistance(const int value);
+[[nodiscard]] int distance();
+
+// Called whenever the geometry or the visibility of a frameless window changes.
+void update(const QWindow *window);
+void remove(const QWindow *window);
+
+// Returns "geometry" (where the pointer alone would put "window") moved
+// onto the closest edges within reach, horizontally and vertically. The edges
+// of "ignored" (the windows moving along with it) don't count.
+[[nodiscard]] QRect snap(const QWindow *window, const QRect &geometry, const QWindowList &ignored);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
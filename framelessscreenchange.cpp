@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessscreenchange_p.h"
+#include "framelesswindowsmanager_p.h"
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace ScreenChangeDeferral
+{
+
+struct PendingScreenChange
+{
+    bool screenChanged = false;
+    bool devicePixelRatioChanged = false;
+    QPointer<QTimer> settleTimer = nullptr;
+};
+
+struct ScreenChangeDeferralData
+{
+    bool enabled = false;
+    int settleInterval = 0;
+    // Set while the held back events are being delivered.
+    bool flushing = false;
+    QHash<const QWindow *, PendingScreenChange> pending = {};
+};
+
+Q_GLOBAL_STATIC(ScreenChangeDeferralData, g_screenChangeDeferralData)
+
+void setEnabled(const bool value)
+{
+    ScreenChangeDeferralData * const data = g_screenChangeDeferralData();
+    data->enabled = value;
+    if (value) {
+        return;
+    }
+    const QList<const QWindow *> windows = data->pending.keys();
+    for (auto &&window : qAsConst(windows)) {
+        flush(const_cast<QWindow *>(window));
+    }
+}
+
+bool isEnabled()
+{
+    return g_screenChangeDeferralData()->enabled;
+}
+
+void setSettleInterval(const int msec)
+{
+    g_screenChangeDeferralData()->settleInterval = qMax(msec, 0);
+}
+
+int settleInterval()
+{
+    return g_screenChangeDeferralData()->settleInterval;
+}
+
+bool isScreenChangeEvent(const QEvent::Type type)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+    if (type == QEvent::DevicePixelRatioChange) {
+        return true;
+    }
+#endif
+    return (type == QEvent::ScreenChangeInternal);
+}
+
+bool defer(QWindow *window, const QEvent::Type type)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return false;
+    }
+    ScreenChangeDeferralData * const data = g_screenChangeDeferralData();
+    if (!data->enabled || data->flushing
+            || (WindowInteraction::state(window) != WindowInteraction::State::Moving)) {
+        return false;
+    }
+    // QWindow itself has switched over already, only the contents (widgets,
+    // Qt Quick items ...) are kept on the previous values for now.
+    PendingScreenChange &pending = data->pending[window];
+    if (type == QEvent::ScreenChangeInternal) {
+        pending.screenChanged = true;
+    } else {
+        pending.devicePixelRatioChanged = true;
+    }
+    windowMoved(window);
+    return true;
+}
+
+void windowMoved(QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    ScreenChangeDeferralData * const data = g_screenChangeDeferralData();
+    if (data->settleInterval <= 0) {
+        return;
+    }
+    const auto it = data->pending.find(window);
+    if (it == data->pending.end()) {
+        return;
+    }
+    if (!it->settleTimer) {
+        it->settleTimer = new QTimer(window);
+        it->settleTimer->setSingleShot(true);
+        QObject::connect(it->settleTimer.data(), &QTimer::timeout, window, [window](){
+            flush(window);
+        });
+    }
+    it->settleTimer->start(data->settleInterval);
+}
+
+void flush(QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    ScreenChangeDeferralData * const data = g_screenChangeDeferralData();
+    const auto it = data->pending.find(window);
+    if (it == data->pending.end()) {
+        return;
+    }
+    const PendingScreenChange pending = it.value();
+    data->pending.erase(it);
+    if (pending.settleTimer) {
+        pending.settleTimer->deleteLater();
+    }
+    data->flushing = true;
+    // One notification for the whole move, describing where the window is now.
+    if (pending.screenChanged) {
+        QEvent event(QEvent::ScreenChangeInternal);
+        QCoreApplication::sendEvent(window, &event);
+    }
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+    if (pending.devicePixelRatioChanged) {
+        QEvent event(QEvent::DevicePixelRatioChange);
+        QCoreApplication::sendEvent(window, &event);
+    }
+#endif
+    data->flushing = false;
+}
+
+void remove(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    const auto it = g_screenChangeDeferralData()->pending.find(window);
+    if (it == g_screenChangeDeferralData()->pending.end()) {
+        return;
+    }
+    if (it->settleTimer) {
+        it->settleTimer->deleteLater();
+    }
+    g_screenChangeDeferralData()->pending.erase(it);
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
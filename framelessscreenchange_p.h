@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+#include <QtCore/qcoreevent.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Holds back the screen and device pixel ratio change notifications a window
+// gets while it's being moved, so that a window dragged across (or along) the
+// border between two screens with different scale factors doesn't relayout
+// and re-rasterize everything each time it crosses it. The last change is
+// delivered once the move has finished, or once the window has stopped
+// moving for the settle interval. GUI thread only.
+namespace ScreenChangeDeferral
+{
+
+// Disabled by default.
+void setEnabled(const bool value);
+[[nodiscard]] bool isEnabled();
+// 0 (the default) means only deliver the changes when the move has finished.
+void setSettleInterval(const int msec);
+[[nodiscard]] int settleInterval();
+
+[[nodiscard]] bool isScreenChangeEvent(const QEvent::Type type);
+// Returns true if the event has been held back and mustn't be delivered.
+[[nodiscard]] bool defer(QWindow *window, const QEvent::Type type);
+// Restarts the settle timer, called for every position change of the window.
+void windowMoved(QWindow *window);
+// Delivers what has been held back, if anything.
+void flush(QWindow *window);
+void remove(const QWindow *window);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessscreenindex_p.h"
+#include <QtCore/qpointer.h>
+#include <QtCore/qvector.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qscreen.h>
+#include <algorithm>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace ScreenIndex
+{
+
+struct ScreenEntry
+{
+    QPointer<QScreen> screen = nullptr;
+    QRect geometry = {};
+    QRect availableGeometry = {};
+};
+
+struct ScreenIndexData
+{
+    bool connected = false;
+    bool valid = false;
+    QVector<ScreenEntry> screens = {};
+    // The distinct screen edges in ascending order (right and bottom edges
+    // exclusive), each cell of the grid they form holds the index of the
+    // screen covering it, or -1.
+    QVector<int> xEdges = {};
+    QVector<int> yEdges = {};
+    QVector<int> cells = {};
+};
+
+Q_GLOBAL_STATIC(ScreenIndexData, g_screenIndexData)
+
+static void invalidate()
+{
+    g_screenIndexData()->valid = false;
+}
+
+static void watchScreen(QScreen *screen)
+{
+    Q_ASSERT(screen);
+    if (!screen) {
+        return;
+    }
+    QObject::connect(screen, &QScreen::geometryChanged, screen, invalidate);
+    QObject::connect(screen, &QScreen::availableGeometryChanged, screen, invalidate);
+}
+
+// Nothing is cached before the application exists, there's no signal to
+// tell us about screen changes otherwise.
+[[nodiscard]] static bool ensureConnected(ScreenIndexData *data)
+{
+    Q_ASSERT(data);
+    if (data->connected) {
+        return true;
+    }
+    const auto app = qobject_cast<QGuiApplication *>(QCoreApplication::instance());
+    if (!app) {
+        return false;
+    }
+    QObject::connect(app, &QGuiApplication::screenAdded, app, [](QScreen *screen){
+        watchScreen(screen);
+        invalidate();
+    });
+    QObject::connect(app, &QGuiApplication::screenRemoved, app, invalidate);
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    for (auto &&screen : qAsConst(screens)) {
+        watchScreen(screen);
+    }
+    data->connected = true;
+    return true;
+}
+
+[[nodiscard]] static inline int edgeIndex(const QVector<int> &edges, const int value)
+{
+    return static_cast<int>(std::lower_bound(edges.cbegin(), edges.cend(), value) - edges.cbegin());
+}
+
+static void sortEdges(QVector<int> *edges)
+{
+    Q_ASSERT(edges);
+    std::sort(edges->begin(), edges->end());
+    edges->erase(std::unique(edges->begin(), edges->end()), edges->end());
+}
+
+static void rebuild(ScreenIndexData *data)
+{
+    Q_ASSERT(data);
+    data->screens.clear();
+    data->xEdges.clear();
+    data->yEdges.clear();
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    data->screens.reserve(screens.size());
+    for (auto &&screen : qAsConst(screens)) {
+        ScreenEntry entry = {};
+        entry.screen = screen;
+        entry.geometry = screen->geometry();
+        entry.availableGeometry = screen->availableGeometry();
+        if (!entry.geometry.isValid()) {
+            continue;
+        }
+        data->xEdges.append(entry.geometry.left());
+        data->xEdges.append(entry.geometry.right() + 1);
+        data->yEdges.append(entry.geometry.top());
+        data->yEdges.append(entry.geometry.bottom() + 1);
+        data->screens.append(entry);
+    }
+    sortEdges(&data->xEdges);
+    sortEdges(&data->yEdges);
+    const int columns = qMax(static_cast<int>(data->xEdges.size()) - 1, 0);
+    const int rows = qMax(static_cast<int>(data->yEdges.size()) - 1, 0);
+    data->cells.fill(-1, (columns * rows));
+    for (int i = 0; i != data->screens.size(); ++i) {
+        const QRect &geometry = data->screens.at(i).geometry;
+        const int left = edgeIndex(data->xEdges, geometry.left());
+        const int right = edgeIndex(data->xEdges, (geometry.right() + 1));
+        const int top = edgeIndex(data->yEdges, geometry.top());
+        const int bottom = edgeIndex(data->yEdges, (geometry.bottom() + 1));
+        for (int row = top; row != bottom; ++row) {
+            for (int column = left; column != right; ++column) {
+                // Overlapping (mirrored) screens: the first one wins, like QGuiApplication::screenAt().
+                int &cell = data->cells[(row * columns) + column];
+                if (cell < 0) {
+                    cell = i;
+                }
+            }
+        }
+    }
+}
+
+[[nodiscard]] static const ScreenIndexData *indexData()
+{
+    ScreenIndexData * const data = g_screenIndexData();
+    if (!data->valid) {
+        rebuild(data);
+        data->valid = ensureConnected(data);
+    }
+    return data;
+}
+
+[[nodiscard]] static int screenIndexAt(const ScreenIndexData *data, const QPoint &globalPos)
+{
+    Q_ASSERT(data);
+    const int columns = (static_cast<int>(data->xEdges.size()) - 1);
+    const int rows = (static_cast<int>(data->yEdges.size()) - 1);
+    // The cell left of (above) the first edge greater than the coordinate.
+    const int column = static_cast<int>(std::upper_bound(data->xEdges.cbegin(), data->xEdges.cend(), globalPos.x())
+                                        - data->xEdges.cbegin()) - 1;
+    const int row = static_cast<int>(std::upper_bound(data->yEdges.cbegin(), data->yEdges.cend(), globalPos.y())
+                                     - data->yEdges.cbegin()) - 1;
+    if ((column < 0) || (column >= columns) || (row < 0) || (row >= rows)) {
+        return -1;
+    }
+    return data->cells.at((row * columns) + column);
+}
+
+QScreen *screenAt(const QPoint &globalPos)
+{
+    const ScreenIndexData * const data = indexData();
+    const int index = screenIndexAt(data, globalPos);
+    return ((index < 0) ? nullptr : data->screens.at(index).screen.data());
+}
+
+QRect availableGeometry(const QPoint &globalPos)
+{
+    const ScreenIndexData * const data = indexData();
+    const int index = screenIndexAt(data, globalPos);
+    return ((index < 0) ? QRect{} : data->screens.at(index).availableGeometry);
+}
+
+QRect availableGeometry(const QScreen *screen)
+{
+    if (!screen) {
+        return {};
+    }
+    const ScreenIndexData * const data = indexData();
+    for (auto &&entry : qAsConst(data->screens)) {
+        if (entry.screen == screen) {
+            return entry.availableGeometry;
+        }
+    }
+    return {};
+}
+
+SnapZone snapZone(const QPoint &globalPos, const int threshold, QRect *geometry)
+{
+    Q_ASSERT(geometry);
+    if (!geometry) {
+        return SnapZone::None;
+    }
+    const ScreenIndexData * const data = indexData();
+    const int index = screenIndexAt(data, globalPos);
+    if (index < 0) {
+        return SnapZone::None;
+    }
+    const ScreenEntry &entry = data->screens.at(index);
+    const QRect &area = entry.availableGeometry;
+    if (!area.isValid()) {
+        return SnapZone::None;
+    }
+    // The pointer stops at an outer edge of the desktop, so touching the edge
+    // of the work area means being within "threshold" of it, or on a panel
+    // beyond it. Where another screen continues past the edge the pointer just
+    // moves on to it, that's not a place to snap.
+    const auto isOuterEdge = [data](const QPoint &beyond) -> bool {
+        return (screenIndexAt(data, beyond) < 0);
+    };
+    if ((globalPos.y() <= (area.top() + threshold)) && isOuterEdge({globalPos.x(), (entry.geometry.top() - 1)})) {
+        *geometry = area;
+        return SnapZone::Maximize;
+    }
+    const int halfWidth = (area.width() / 2);
+    if ((globalPos.x() <= (area.left() + threshold)) && isOuterEdge({(entry.geometry.left() - 1), globalPos.y()})) {
+        *geometry = {area.left(), area.top(), halfWidth, area.height()};
+        return SnapZone::LeftHalf;
+    }
+    if ((globalPos.x() >= (area.right() - threshold)) && isOuterEdge({(entry.geometry.right() + 1), globalPos.y()})) {
+        *geometry = {(area.left() + halfWidth), area.top(), (area.width() - halfWidth), area.height()};
+        return SnapZone::RightHalf;
+    }
+    return SnapZone::None;
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
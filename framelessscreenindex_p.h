@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+#include <QtCore/qrect.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QScreen)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// A cache of the screen geometries, kept up to date from the screen signals,
+// so that the code running for every mouse move never has to walk the screen
+// list or ask the platform for the work areas. Point lookups go through a grid
+// built from the screen edges: two binary searches, whatever the screen count.
+// GUI thread only.
+namespace ScreenIndex
+{
+
+enum class SnapZone : int
+{
+    None = 0,
+    Maximize,  // The pointer touches the top of the work area.
+    LeftHalf,  // The pointer touches the left edge of the work area.
+    RightHalf  // The pointer touches the right edge of the work area.
+};
+
+// Returns nullptr if the point isn't on any screen.
+[[nodiscard]] QScreen *screenAt(const QPoint &globalPos);
+// The work area of the screen under the point, a null rect if there's none.
+[[nodiscard]] QRect availableGeometry(const QPoint &globalPos);
+// The work area of the screen, a null rect if it's unknown.
+[[nodiscard]] QRect availableGeometry(const QScreen *screen);
+// Which snap zone the point is in, and the geometry a window dropped there gets.
+// Only the outer edges of the desktop snap, not the ones between two screens.
+[[nodiscard]] SnapZone snapZone(const QPoint &globalPos, const int threshold, QRect *geometry);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
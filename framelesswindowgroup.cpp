@@ -0,0 +1,245 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelesswindowgroup_p.h"
+#include "framelessflightrecorder_p.h"
+#include "framelesshelper_trace_p.h"
+#include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qvector.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace WindowGroup
+{
+
+struct GroupMember
+{
+    QPointer<QWindow> window = nullptr;
+    QPoint offset = {};
+};
+
+struct GroupMove
+{
+    QVector<GroupMember> members = {};
+    QPoint position = {};
+    // Set once FramelessHelper commits the leader's position itself.
+    bool committed = false;
+    QMetaObject::Connection xConnection = {};
+    QMetaObject::Connection yConnection = {};
+};
+
+struct WindowGroupData
+{
+    QHash<const QWindow *, QList<QPointer<QWindow>>> groups = {};
+    QHash<const QWindow *, const QWindow *> leaders = {};
+    QHash<const QWindow *, GroupMove> moves = {};
+};
+
+Q_GLOBAL_STATIC(WindowGroupData, g_windowGroupData)
+
+static void moveMembers(const QWindow *leader, const QPoint &position)
+{
+    Q_ASSERT(leader);
+    if (!leader) {
+        return;
+    }
+    const auto it = g_windowGroupData()->moves.find(leader);
+    if ((it == g_windowGroupData()->moves.end()) || (it->position == position)) {
+        return;
+    }
+    it->position = position;
+    // All the members are sent in one go, with nothing processed in between,
+    // so that they reach the window system in the same batch as the leader.
+    for (auto &&member : qAsConst(it->members)) {
+        QWindow * const window = member.window.data();
+        if (!window) {
+            continue;
+        }
+        const QPoint target = (position + member.offset);
+        if (window->position() == target) {
+            continue;
+        }
+        window->setPosition(target);
+        const QRect geometry = {target, window->size()};
+        FramelessFlightRecorder::recordGeometryCommit(window, geometry);
+        FRAMELESSHELPER_TRACE(setGeometry, window, geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        // Not counted in the member's statistics: the member isn't being moved
+        // or resized itself, so the commit doesn't belong to any interaction of its own.
+    }
+}
+
+void add(QWindow *leader, QWindow *member)
+{
+    Q_ASSERT(leader);
+    Q_ASSERT(member);
+    if (!leader || !member || (leader == member)) {
+        return;
+    }
+    WindowGroupData * const data = g_windowGroupData();
+    if (data->leaders.contains(leader)) {
+        qWarning() << leader << "is a member of another window group, it can't lead one.";
+        return;
+    }
+    if (data->groups.contains(member)) {
+        qWarning() << member << "leads a window group, it can't be a member of another one.";
+        return;
+    }
+    const bool newGroup = !data->groups.contains(leader);
+    const bool newMember = !data->leaders.contains(member);
+    remove(member);
+    data->groups[leader].append(member);
+    data->leaders.insert(member, leader);
+    if (newGroup) {
+        QObject::connect(leader, &QObject::destroyed, leader, [leader](){
+            remove(leader);
+        });
+    }
+    if (newMember) {
+        QObject::connect(member, &QObject::destroyed, member, [member](){
+            remove(member);
+        });
+    }
+}
+
+void remove(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    WindowGroupData * const data = g_windowGroupData();
+    const auto group = data->groups.find(window);
+    if (group != data->groups.end()) {
+        for (auto &&member : qAsConst(group.value())) {
+            data->leaders.remove(member.data());
+        }
+        data->groups.erase(group);
+        end(window);
+    }
+    const QWindow * const leader = data->leaders.take(window);
+    if (!leader) {
+        return;
+    }
+    QList<QPointer<QWindow>> &members = data->groups[leader];
+    for (int i = (members.size() - 1); i >= 0; --i) {
+        if (!members.at(i) || (members.at(i) == window)) {
+            members.removeAt(i);
+        }
+    }
+    if (members.isEmpty()) {
+        data->groups.remove(leader);
+    }
+    const auto move = data->moves.find(leader);
+    if (move != data->moves.end()) {
+        for (auto &&member : move->members) {
+            if (member.window == window) {
+                member.window = nullptr;
+            }
+        }
+    }
+}
+
+QWindowList members(const QWindow *leader)
+{
+    Q_ASSERT(leader);
+    if (!leader) {
+        return {};
+    }
+    QWindowList result = {};
+    const QList<QPointer<QWindow>> members = g_windowGroupData()->groups.value(leader);
+    for (auto &&member : qAsConst(members)) {
+        if (member) {
+            result.append(member.data());
+        }
+    }
+    return result;
+}
+
+void begin(QWindow *leader)
+{
+    Q_ASSERT(leader);
+    if (!leader) {
+        return;
+    }
+    WindowGroupData * const data = g_windowGroupData();
+    const auto group = data->groups.constFind(leader);
+    if (group == data->groups.constEnd()) {
+        return;
+    }
+    end(leader);
+    GroupMove move = {};
+    move.position = leader->position();
+    for (auto &&member : qAsConst(group.value())) {
+        if (member) {
+            move.members.append({member, (member->position() - move.position)});
+        }
+    }
+    // The system moves the leader on its own (MoveResizeMode::System, and
+    // always on Windows), follow the position it reports.
+    const auto follow = [leader](){
+        const auto it = g_windowGroupData()->moves.constFind(leader);
+        if ((it != g_windowGroupData()->moves.constEnd()) && !it->committed) {
+            moveMembers(leader, leader->position());
+        }
+    };
+    move.xConnection = QObject::connect(leader, &QWindow::xChanged, leader, follow);
+    move.yConnection = QObject::connect(leader, &QWindow::yChanged, leader, follow);
+    data->moves.insert(leader, move);
+}
+
+void end(const QWindow *leader)
+{
+    Q_ASSERT(leader);
+    if (!leader) {
+        return;
+    }
+    const auto it = g_windowGroupData()->moves.find(leader);
+    if (it == g_windowGroupData()->moves.end()) {
+        return;
+    }
+    QObject::disconnect(it->xConnection);
+    QObject::disconnect(it->yConnection);
+    g_windowGroupData()->moves.erase(it);
+}
+
+void commit(const QWindow *leader, const QPoint &position)
+{
+    Q_ASSERT(leader);
+    if (!leader) {
+        return;
+    }
+    const auto it = g_windowGroupData()->moves.find(leader);
+    if (it == g_windowGroupData()->moves.end()) {
+        return;
+    }
+    it->committed = true;
+    moveMembers(leader, position);
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+
+#include <QtCore/qpoint.h>
+#include <QtGui/qwindowdefs.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Windows which move along with a leader window, keeping their offset to it.
+// The offsets are taken when the leader starts moving, so the members can
+// still be moved around on their own in between. Every member keeps its own
+// FramelessHelper state, only the leader's move is shared.
+namespace WindowGroup
+{
+
+void add(QWindow *leader, QWindow *member);
+// Takes "window" out of its group, or dissolves the group it leads.
+void remove(const QWindow *window);
+[[nodiscard]] QWindowList members(const QWindow *leader);
+
+// Called by WindowInteraction::setState() when "leader" starts and stops moving.
+void begin(QWindow *leader);
+void end(const QWindow *leader);
+// Called right after the leader's own position has been committed, so that
+// all the members go out together with it. Once this has been called, the
+// leader's position change notifications (which may lag behind) are ignored
+// for the rest of the move; they only drive the members when the system moves
+// the leader.
+void commit(const QWindow *leader, const QPoint &position);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
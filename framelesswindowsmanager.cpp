@@ -22,44 +22,261 @@
  * SOFTWARE.
  */
 
-#include "framelesswindowsmanager.h"
+#include "framelesswindowsmanager_p.h"
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qvariant.h>
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qfutureinterface.h>
 #include <QtGui/qwindow.h>
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qcursor.h>
+#include <QtGui/qscreen.h>
+#include <QtGui/qpa/qplatformcursor.h>
+#include <QtGui/qpa/qplatformscreen.h>
 #include "framelesshelper.h"
 #else
 #include <QtGui/qscreen.h>
 #include "framelesshelper_win32.h"
 #endif
 #include "utilities.h"
+#include "framelesswindowstatistics_p.h"
+#include "framelessmagnetism_p.h"
+#include "framelesswindowgroup_p.h"
+#include "framelessscreenchange_p.h"
+#include "framelesshelper_trace_p.h"
+#include "framelessliveresize_p.h"
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+#include "themehelper_linux_p.h"
+#endif
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
 Q_GLOBAL_STATIC(FramelessHelper, framelessHelperUnix)
+
+struct FramelessWindowsManagerData
+{
+    bool cursorPrewarmingEnabled = true;
+    QList<QPointer<QScreen>> prewarmedScreens = {};
+};
+
+Q_GLOBAL_STATIC(FramelessWindowsManagerData, g_framelessWindowsManagerData)
+
+static void prewarmCursors(QScreen *screen)
+{
+    Q_ASSERT(screen);
+    if (!screen) {
+        return;
+    }
+    FramelessWindowsManagerData * const data = g_framelessWindowsManagerData();
+    if (data->prewarmedScreens.contains(screen)) {
+        return;
+    }
+    QPlatformCursor * const platformCursor = screen->handle()->cursor();
+    if (!platformCursor) {
+        return;
+    }
+    data->prewarmedScreens.removeAll(QPointer<QScreen>());
+    data->prewarmedScreens.append(screen);
+    // The platform cursors are created lazily and cached per screen, but on
+    // X11 creating one means loading the cursor theme from disk, which makes
+    // the first hover over a window edge hitch. Create them up front instead.
+    // They are only created when they are set on a native window, a hidden
+    // one is used so that no visible window shows them for a moment.
+    QWindow window(screen);
+    window.create();
+    static const Qt::CursorShape shapes[] = {
+        Qt::ArrowCursor, Qt::SizeVerCursor, Qt::SizeHorCursor,
+        Qt::SizeBDiagCursor, Qt::SizeFDiagCursor, Qt::SizeAllCursor
+    };
+    for (auto &&shape : shapes) {
+        QCursor cursor(shape);
+        platformCursor->changeCursor(&cursor, &window);
+    }
+}
+
+namespace CursorPrewarming
+{
+
+void schedule(QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window || !g_framelessWindowsManagerData()->cursorPrewarmingEnabled) {
+        return;
+    }
+    // Off the show and hover paths: once the current event has been handled.
+    QTimer::singleShot(0, window, [window](){
+        QScreen * const screen = window->screen();
+        if (screen && g_framelessWindowsManagerData()->cursorPrewarmingEnabled) {
+            prewarmCursors(screen);
+        }
+    });
+}
+
+}
 #endif
 
+namespace WindowInteraction
+{
+
+struct WindowInteractionData
+{
+    QHash<const QWindow *, State> states = {};
+};
+
+Q_GLOBAL_STATIC(WindowInteractionData, g_windowInteractionData)
+
+void setState(QWindow *window, const State state, const Qt::Edges edges)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    const State previousState = WindowInteraction::state(window);
+    if (previousState == state) {
+        return;
+    }
+    if (state == State::Idle) {
+        g_windowInteractionData()->states.remove(window);
+    } else {
+        g_windowInteractionData()->states.insert(window, state);
+    }
+    FramelessFlightRecorder::recordStateTransition(window, previousState, state);
+    FramelessWindowsManager * const manager = FramelessWindowsManager::instance();
+    if (previousState == State::Moving) {
+        FRAMELESSHELPER_TRACE(moveEnd, window, window->x(), window->y());
+        WindowGroup::end(window);
+        ScreenChangeDeferral::flush(window);
+        Q_EMIT manager->moveFinished(window);
+    } else if (previousState == State::Resizing) {
+        FRAMELESSHELPER_TRACE(resizeEnd, window, window->width(), window->height());
+        LiveResize::end(window);
+        Q_EMIT manager->resizeFinished(window, window->geometry());
+    }
+    if (state == State::Idle) {
+        WindowStatistics::recordInteractionFinished(window);
+    } else if (state == State::Moving) {
+        FRAMELESSHELPER_TRACE(moveStart, window, window->x(), window->y());
+        WindowGroup::begin(window);
+        Q_EMIT manager->moveStarted(window);
+    } else if (state == State::Resizing) {
+        FRAMELESSHELPER_TRACE(resizeStart, window, static_cast<int>(edges), window->width(), window->height());
+        LiveResize::begin(window, edges);
+        Q_EMIT manager->resizeStarted(window);
+    }
+}
+
+State state(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return State::Idle;
+    }
+    return g_windowInteractionData()->states.value(window, State::Idle);
+}
+
+void remove(const QWindow *window)
+{
+    g_windowInteractionData()->states.remove(window);
+}
+
+}
+
+static void startSystemProbe()
+{
+    // Kick off the probe while the application is still being set up.
+    Q_UNUSED(FramelessWindowsManager::instance());
+}
+Q_COREAPP_STARTUP_FUNCTION(startSystemProbe)
+
+FramelessWindowsManager::FramelessWindowsManager(QObject *parent) : QObject(parent) {}
+
+FramelessWindowsManager::~FramelessWindowsManager() = default;
+
+FramelessWindowsManager *FramelessWindowsManager::instance()
+{
+    static FramelessWindowsManager manager;
+    // The manager can be used before the application object exists, but the
+    // system probe only starts together with the latter.
+    if (!manager.m_systemProbeConnected && QCoreApplication::instance()) {
+        manager.connectSystemProbe();
+    }
+    return &manager;
+}
+
+void FramelessWindowsManager::connectSystemProbe()
+{
+    m_systemProbeConnected = true;
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    ThemeHelperLinux * const themeHelper = ThemeHelperLinux::instance();
+    if (themeHelper) {
+        connect(themeHelper, &ThemeHelperLinux::probeFinished, this, &FramelessWindowsManager::systemProbeReady);
+        // Other parts of the library create the theme helper on demand as well,
+        // it may have been around for a while already.
+        if (themeHelper->isInitialProbeHandled()) {
+            QMetaObject::invokeMethod(this, "systemProbeReady", Qt::QueuedConnection);
+        }
+        return;
+    }
+#endif
+    // Nothing to probe on this platform, the system values are always queried directly.
+    QMetaObject::invokeMethod(this, "systemProbeReady", Qt::QueuedConnection);
+}
+
+void FramelessWindowsManager::handleScreenChanged()
+{
+    const auto window = qobject_cast<QWindow *>(sender());
+    if (!window) {
+        return;
+    }
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+    CursorPrewarming::schedule(window);
+#else
+    // Work-around a Win32 multi-monitor bug.
+    window->resize(window->size());
+#endif
+}
+
+QFuture<void> FramelessWindowsManager::systemProbe()
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    return ThemeHelperLinux::initialProbe();
+#else
+    QFutureInterface<void> futureInterface;
+    futureInterface.reportStarted();
+    futureInterface.reportFinished();
+    return futureInterface.future();
+#endif
+}
+
 void FramelessWindowsManager::addWindow(QWindow *window)
 {
     Q_ASSERT(window);
     if (!window) {
         return;
     }
+    FRAMELESSHELPER_TRACE(addWindow, window);
     if (!QCoreApplication::testAttribute(Qt::AA_DontCreateNativeWidgetSiblings)) {
         QCoreApplication::setAttribute(Qt::AA_DontCreateNativeWidgetSiblings);
     }
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
     framelessHelperUnix()->removeWindowFrame(window);
+    // Otherwise FramelessHelper does it once the native window has been created.
+    if (window->handle()) {
+        CursorPrewarming::schedule(window);
+    }
 #else
     FramelessHelperWin::addFramelessWindow(window);
-    // Work-around a Win32 multi-monitor bug.
-    QObject::connect(window, &QWindow::screenChanged, [window](QScreen *screen){
-        Q_UNUSED(screen);
-        window->resize(window->size());
-    });
 #endif
+    // The startup hook may not have run (e.g. static builds), make sure the
+    // system probe has been started. The window uses the default values until
+    // it has finished.
+    FramelessWindowsManager * const manager = instance();
+    // Adding a window twice must not connect twice.
+    connect(window, &QWindow::screenChanged, manager, &FramelessWindowsManager::handleScreenChanged, Qt::UniqueConnection);
 }
 
 void FramelessWindowsManager::setHitTestVisible(QWindow *window, QObject *object, const bool value)
@@ -74,14 +291,14 @@ void FramelessWindowsManager::setHitTestVisible(QWindow *window, QObject *object
         return;
     }
     auto objList = qvariant_cast<QObjectList>(window->property(Constants::kHitTestVisibleFlag));
+    // Every property change invalidates the settings cached by the event filter.
+    if (objList.contains(object) == value) {
+        return;
+    }
     if (value) {
-        if (objList.isEmpty() || !objList.contains(object)) {
-            objList.append(object);
-        }
+        objList.append(object);
     } else {
-        if (!objList.isEmpty() && objList.contains(object)) {
-            objList.removeAll(object);
-        }
+        objList.removeAll(object);
     }
     window->setProperty(Constants::kHitTestVisibleFlag, QVariant::fromValue(objList));
 }
@@ -92,12 +309,7 @@ int FramelessWindowsManager::getResizeBorderThickness(const QWindow *window)
     if (!window) {
         return 8;
     }
-#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    const int value = window->property(Constants::kResizeBorderThicknessFlag).toInt();
-    return value <= 0 ? 8 : value;
-#else
     return Utilities::getSystemMetric(window, SystemMetric::ResizeBorderThickness, false);
-#endif
 }
 
 void FramelessWindowsManager::setResizeBorderThickness(QWindow *window, const int value)
@@ -158,17 +370,295 @@ void FramelessWindowsManager::setResizable(QWindow *window, const bool value)
 #endif
 }
 
+MoveResizeMode FramelessWindowsManager::getMoveResizeMode(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return MoveResizeMode::Manual;
+    }
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+    return static_cast<MoveResizeMode>(window->property(Constants::kMoveResizeModeFlag).toInt());
+#else
+    return MoveResizeMode::System;
+#endif
+}
+
+void FramelessWindowsManager::setMoveResizeMode(QWindow *window, const MoveResizeMode value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+    window->setProperty(Constants::kMoveResizeModeFlag, static_cast<int>(value));
+#else
+    Q_UNUSED(value);
+#endif
+}
+
+LiveResizeMode FramelessWindowsManager::getLiveResizeMode(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return LiveResizeMode::Default;
+    }
+    return static_cast<LiveResizeMode>(window->property(Constants::kLiveResizeModeFlag).toInt());
+}
+
+void FramelessWindowsManager::setLiveResizeMode(QWindow *window, const LiveResizeMode value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    window->setProperty(Constants::kLiveResizeModeFlag, static_cast<int>(value));
+}
+
+QSize FramelessWindowsManager::getSizeIncrement(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+    return window->sizeIncrement();
+}
+
+void FramelessWindowsManager::setSizeIncrement(QWindow *window, const QSize &value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    window->setSizeIncrement(value);
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    // Qt has just rewritten WM_NORMAL_HINTS without the aspect ratio.
+    Utilities::updateWindowSizeHints(window);
+#endif
+}
+
+QSize FramelessWindowsManager::getBaseSize(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+    return window->baseSize();
+}
+
+void FramelessWindowsManager::setBaseSize(QWindow *window, const QSize &value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    window->setBaseSize(value);
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    // Qt has just rewritten WM_NORMAL_HINTS without the aspect ratio.
+    Utilities::updateWindowSizeHints(window);
+#endif
+}
+
+qreal FramelessWindowsManager::getAspectRatio(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return 0.0;
+    }
+    return window->property(Constants::kAspectRatioFlag).toReal();
+}
+
+void FramelessWindowsManager::setAspectRatio(QWindow *window, const qreal value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    const qreal aspectRatio = qMax(value, 0.0);
+    window->setProperty(Constants::kAspectRatioFlag, aspectRatio);
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    Utilities::updateWindowSizeHints(window);
+#endif
+    if (aspectRatio <= 0.0) {
+        // Once it has been removed from the size hints, there's no need to
+        // look at them again when a resize starts.
+        window->setProperty(Constants::kAspectRatioFlag, QVariant());
+    }
+}
+
+bool FramelessWindowsManager::isEdgeSnappingEnabled(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return false;
+    }
+    return window->property(Constants::kEdgeSnappingFlag).toBool();
+}
+
+void FramelessWindowsManager::setEdgeSnappingEnabled(QWindow *window, const bool value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    window->setProperty(Constants::kEdgeSnappingFlag, value);
+}
+
+bool FramelessWindowsManager::isMouseEventConsumptionEnabled(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return false;
+    }
+    return window->property(Constants::kConsumeMouseEventsFlag).toBool();
+}
+
+void FramelessWindowsManager::setMouseEventConsumptionEnabled(QWindow *window, const bool value)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    window->setProperty(Constants::kConsumeMouseEventsFlag, value);
+}
+
 void FramelessWindowsManager::removeWindow(QWindow *window)
 {
     Q_ASSERT(window);
     if (!window) {
         return;
     }
+    FRAMELESSHELPER_TRACE(removeWindow, window);
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
     framelessHelperUnix()->bringBackWindowFrame(window);
 #else
     FramelessHelperWin::removeFramelessWindow(window);
 #endif
+    disconnect(window, &QWindow::screenChanged, instance(), &FramelessWindowsManager::handleScreenChanged);
+    WindowStatistics::remove(window);
+    WindowInteraction::remove(window);
+    WindowMagnetism::remove(window);
+    WindowGroup::remove(window);
+    ScreenChangeDeferral::remove(window);
+}
+
+void FramelessWindowsManager::setCursorPrewarmingEnabled(const bool value)
+{
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+    g_framelessWindowsManagerData()->cursorPrewarmingEnabled = value;
+#else
+    // The system draws the resize cursors itself on Windows.
+    Q_UNUSED(value);
+#endif
+}
+
+void FramelessWindowsManager::setWindowMagnetismEnabled(const bool value)
+{
+    WindowMagnetism::setEnabled(value);
+}
+
+bool FramelessWindowsManager::isWindowMagnetismEnabled()
+{
+    return WindowMagnetism::isEnabled();
+}
+
+void FramelessWindowsManager::setWindowMagnetismDistance(const int value)
+{
+    WindowMagnetism::setDistance(value);
+}
+
+int FramelessWindowsManager::getWindowMagnetismDistance()
+{
+    return WindowMagnetism::distance();
+}
+
+void FramelessWindowsManager::addWindowToGroup(QWindow *leader, QWindow *member)
+{
+    Q_ASSERT(leader);
+    Q_ASSERT(member);
+    if (!leader || !member) {
+        return;
+    }
+    WindowGroup::add(leader, member);
+}
+
+void FramelessWindowsManager::removeWindowFromGroup(QWindow *member)
+{
+    Q_ASSERT(member);
+    if (!member) {
+        return;
+    }
+    WindowGroup::remove(member);
+}
+
+QWindowList FramelessWindowsManager::windowGroup(const QWindow *leader)
+{
+    Q_ASSERT(leader);
+    if (!leader) {
+        return {};
+    }
+    return WindowGroup::members(leader);
+}
+
+void FramelessWindowsManager::setScreenChangeDeferralEnabled(const bool value, const int settleInterval)
+{
+    ScreenChangeDeferral::setSettleInterval(settleInterval);
+    ScreenChangeDeferral::setEnabled(value);
+}
+
+bool FramelessWindowsManager::isScreenChangeDeferralEnabled()
+{
+    return ScreenChangeDeferral::isEnabled();
+}
+
+void FramelessWindowsManager::setStatisticsEnabled(const bool value)
+{
+    WindowStatistics::setEnabled(value);
+}
+
+bool FramelessWindowsManager::isStatisticsEnabled()
+{
+    return WindowStatistics::isEnabled();
+}
+
+FramelessWindowStatistics FramelessWindowsManager::statistics(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+    return WindowStatistics::snapshot(window);
+}
+
+QJsonObject FramelessWindowsManager::statisticsJson(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+    return WindowStatistics::snapshot(window).toJson();
+}
+
+void FramelessWindowsManager::resetStatistics(const QWindow *window)
+{
+    WindowStatistics::reset(window);
+}
+
+bool FramelessWindowsManager::isInteractivelyMoving(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return false;
+    }
+    return (WindowInteraction::state(window) == WindowInteraction::State::Moving);
+}
+
+bool FramelessWindowsManager::isInteractivelyResizing(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return false;
+    }
+    return (WindowInteraction::state(window) == WindowInteraction::State::Resizing);
 }
 
 bool FramelessWindowsManager::isWindowFrameless(const QWindow *window)
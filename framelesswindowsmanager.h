@@ -25,28 +25,131 @@
 #pragma once
 
 #include "framelesshelper_global.h"
+#include "framelesswindowstatistics.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qrect.h>
+#include <QtGui/qwindowdefs.h>
 
 QT_BEGIN_NAMESPACE
-QT_FORWARD_DECLARE_CLASS(QObject)
 QT_FORWARD_DECLARE_CLASS(QWindow)
 QT_END_NAMESPACE
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
-namespace FramelessWindowsManager
+class FRAMELESSHELPER_API FramelessWindowsManager : public QObject
 {
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(FramelessWindowsManager)
 
-FRAMELESSHELPER_API void addWindow(QWindow *window);
-FRAMELESSHELPER_API void removeWindow(QWindow *window);
-[[nodiscard]] FRAMELESSHELPER_API bool isWindowFrameless(const QWindow *window);
-FRAMELESSHELPER_API void setHitTestVisible(QWindow *window, QObject *object, const bool value = true);
-[[nodiscard]] FRAMELESSHELPER_API int getResizeBorderThickness(const QWindow *window);
-FRAMELESSHELPER_API void setResizeBorderThickness(QWindow *window, const int value);
-[[nodiscard]] FRAMELESSHELPER_API int getTitleBarHeight(const QWindow *window);
-FRAMELESSHELPER_API void setTitleBarHeight(QWindow *window, const int value);
-[[nodiscard]] FRAMELESSHELPER_API bool getResizable(const QWindow *window);
-FRAMELESSHELPER_API void setResizable(QWindow *window, const bool value = true);
-
-}
+public:
+    ~FramelessWindowsManager() override;
+
+    // The only instance, it only exists for its signals.
+    [[nodiscard]] static FramelessWindowsManager *instance();
+
+    static void addWindow(QWindow *window);
+    static void removeWindow(QWindow *window);
+    [[nodiscard]] static bool isWindowFrameless(const QWindow *window);
+    static void setHitTestVisible(QWindow *window, QObject *object, const bool value = true);
+    [[nodiscard]] static int getResizeBorderThickness(const QWindow *window);
+    static void setResizeBorderThickness(QWindow *window, const int value);
+    [[nodiscard]] static int getTitleBarHeight(const QWindow *window);
+    static void setTitleBarHeight(QWindow *window, const int value);
+    [[nodiscard]] static bool getResizable(const QWindow *window);
+    static void setResizable(QWindow *window, const bool value = true);
+    // Only used by the Unix version, Windows always lets the system do it.
+    [[nodiscard]] static MoveResizeMode getMoveResizeMode(const QWindow *window);
+    static void setMoveResizeMode(QWindow *window, const MoveResizeMode value);
+    // How the window content follows an interactive resize, see LiveResizeMode.
+    [[nodiscard]] static LiveResizeMode getLiveResizeMode(const QWindow *window);
+    static void setLiveResizeMode(QWindow *window, const LiveResizeMode value);
+    // Interactive resizing only produces sizes of "base size + n * size increment"
+    // (the base size defaults to the minimum size) with the given width to height
+    // ratio (0 means no constraint). The window manager is told as well, for
+    // MoveResizeMode::System.
+    [[nodiscard]] static QSize getSizeIncrement(const QWindow *window);
+    static void setSizeIncrement(QWindow *window, const QSize &value);
+    [[nodiscard]] static QSize getBaseSize(const QWindow *window);
+    static void setBaseSize(QWindow *window, const QSize &value);
+    [[nodiscard]] static qreal getAspectRatio(const QWindow *window);
+    static void setAspectRatio(QWindow *window, const qreal value);
+    // Dragging the window to the top of a screen maximizes it, to the left or
+    // right edge tiles it to that half of the screen. A preview of the result
+    // is shown while the pointer is there. Unix version, MoveResizeMode::Manual only,
+    // disabled by default.
+    [[nodiscard]] static bool isEdgeSnappingEnabled(const QWindow *window);
+    static void setEdgeSnappingEnabled(QWindow *window, const bool value = true);
+    // The mouse events used for dragging and resizing the window (presses on
+    // the resize edges, moves while dragging or resizing ...) are not delivered
+    // to the window contents. Events for hit test visible controls are always
+    // delivered. Unix version only, disabled by default.
+    [[nodiscard]] static bool isMouseEventConsumptionEnabled(const QWindow *window);
+    static void setMouseEventConsumptionEnabled(QWindow *window, const bool value = true);
+
+    // Create the resize cursors of a screen when the first frameless window is
+    // shown on it, instead of the first time the user hovers an edge. Enabled by default.
+    static void setCursorPrewarmingEnabled(const bool value = true);
+
+    // Frameless windows dragged close to each other (or to the edges of the
+    // work area) stick together. Unix version, MoveResizeMode::Manual only,
+    // disabled by default.
+    static void setWindowMagnetismEnabled(const bool value = true);
+    [[nodiscard]] static bool isWindowMagnetismEnabled();
+    // How close (in pixels) two edges have to get, 10 by default.
+    static void setWindowMagnetismDistance(const int value);
+    [[nodiscard]] static int getWindowMagnetismDistance();
+
+    // Members of a window group move along with their leader (and keep their
+    // offset to it) whenever the leader is dragged. A window can either lead
+    // one group or be a member of one.
+    static void addWindowToGroup(QWindow *leader, QWindow *member);
+    static void removeWindowFromGroup(QWindow *member);
+    [[nodiscard]] static QWindowList windowGroup(const QWindow *leader);
+
+    // Screen and device pixel ratio changes of a window which is being moved
+    // reach its contents only once, when the move has finished, or as soon as
+    // the window has stayed where it is for "settleInterval" milliseconds (if
+    // not 0). Unix version only, disabled by default.
+    static void setScreenChangeDeferralEnabled(const bool value = true, const int settleInterval = 0);
+    [[nodiscard]] static bool isScreenChangeDeferralEnabled();
+
+    // True between the start and the end of an interactive move or resize,
+    // whether it's done by us, by the window manager or by Windows itself.
+    [[nodiscard]] static bool isInteractivelyMoving(const QWindow *window);
+    [[nodiscard]] static bool isInteractivelyResizing(const QWindow *window);
+
+    // Per-window counters and latency histograms of the interactive move and
+    // resize path. Disabled by default, collecting them costs a clock read per event.
+    // Only the Unix version fills them, the system does the work on Windows.
+    static void setStatisticsEnabled(const bool value = true);
+    [[nodiscard]] static bool isStatisticsEnabled();
+    [[nodiscard]] static FramelessWindowStatistics statistics(const QWindow *window);
+    [[nodiscard]] static QJsonObject statisticsJson(const QWindow *window);
+    // Resets the statistics of all windows if "window" is null.
+    static void resetStatistics(const QWindow *window = nullptr);
+
+    // The system theme and metrics are probed on a worker thread as soon as
+    // the library is loaded, the windows use the default values until then.
+    [[nodiscard]] static QFuture<void> systemProbe();
+
+Q_SIGNALS:
+    void systemProbeReady();
+    // Expensive work (relayouts, video scaling ...) can be deferred until
+    // the interaction has finished, the intermediate sizes are short-lived.
+    void moveStarted(QWindow *window);
+    void moveFinished(QWindow *window);
+    void resizeStarted(QWindow *window);
+    void resizeFinished(QWindow *window, const QRect &finalGeometry);
+
+private:
+    explicit FramelessWindowsManager(QObject *parent = nullptr);
+
+    void connectSystemProbe();
+    void handleScreenChanged();
+
+private:
+    bool m_systemProbeConnected = false;
+};
 
 FRAMELESSHELPER_END_NAMESPACE
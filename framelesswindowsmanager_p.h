@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesswindowsmanager.h"
+#include "framelessflightrecorder_p.h"
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace WindowInteraction
+{
+
+using State = FramelessFlightRecorder::InteractionState;
+
+// Called by the manual/system (FramelessHelper) and the native
+// (FramelessHelperWin) implementations whenever a window starts or stops being
+// moved or resized. Records the transition and emits the lifecycle signals
+// of FramelessWindowsManager. "edges" is only meaningful for State::Resizing.
+void setState(QWindow *window, const State state, const Qt::Edges edges = {});
+[[nodiscard]] State state(const QWindow *window);
+void remove(const QWindow *window);
+
+}
+
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+namespace CursorPrewarming
+{
+
+// Creates the resize cursors of the window's screen soon, unless that has been
+// done already or cursor prewarming is disabled. The window must have a native
+// window already to be sure it's on its final screen.
+void schedule(QWindow *window);
+
+}
+#endif
+
+FRAMELESSHELPER_END_NAMESPACE
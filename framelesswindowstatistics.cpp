@@ -0,0 +1,306 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelesswindowstatistics_p.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qdatetime.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+[[nodiscard]] static inline int bucketIndex(const quint64 value)
+{
+    if (value < quint64(LatencyHistogram::kSubBucketCount)) {
+        return static_cast<int>(value);
+    }
+    const int msb = (63 - qCountLeadingZeroBits(value));
+    const int shift = (msb - LatencyHistogram::kSubBucketBits);
+    return ((shift * LatencyHistogram::kSubBucketCount) + static_cast<int>(value >> shift));
+}
+
+// The smallest value which falls into the given bucket.
+[[nodiscard]] static inline quint64 bucketLowerBound(const int index)
+{
+    if (index < (LatencyHistogram::kSubBucketCount * 2)) {
+        return static_cast<quint64>(index);
+    }
+    const int shift = ((index / LatencyHistogram::kSubBucketCount) - 1);
+    return (static_cast<quint64>(index - (shift * LatencyHistogram::kSubBucketCount)) << shift);
+}
+
+void LatencyHistogram::record(const qint64 nsecs)
+{
+    const qint64 value = qMax(nsecs, qint64(0));
+    ++m_buckets[bucketIndex(static_cast<quint64>(value))];
+    m_min = ((m_count == 0) ? value : qMin(m_min, value));
+    m_max = ((m_count == 0) ? value : qMax(m_max, value));
+    m_total += value;
+    ++m_count;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_total = 0;
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+qint64 LatencyHistogram::min() const
+{
+    return m_min;
+}
+
+qint64 LatencyHistogram::max() const
+{
+    return m_max;
+}
+
+qint64 LatencyHistogram::mean() const
+{
+    return ((m_count == 0) ? 0 : (m_total / static_cast<qint64>(m_count)));
+}
+
+qint64 LatencyHistogram::percentile(const qreal percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    const auto threshold = static_cast<quint64>(qCeil(qBound(0.0, percentile, 100.0) / 100.0 * static_cast<qreal>(m_count)));
+    quint64 total = 0;
+    for (int i = 0; i != kBucketCount; ++i) {
+        total += m_buckets[i];
+        if ((total >= threshold) && (total > 0)) {
+            if ((i + 1) == kBucketCount) {
+                return m_max;
+            }
+            // Report the highest value the bucket stands for, like HdrHistogram does.
+            const auto upperBound = static_cast<qint64>(bucketLowerBound(i + 1) - 1);
+            return qBound(m_min, upperBound, m_max);
+        }
+    }
+    return m_max;
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    return {
+        {QStringLiteral("count"), static_cast<qint64>(m_count)},
+        {QStringLiteral("min"), m_min},
+        {QStringLiteral("max"), m_max},
+        {QStringLiteral("mean"), mean()},
+        {QStringLiteral("p50"), percentile(50.0)},
+        {QStringLiteral("p90"), percentile(90.0)},
+        {QStringLiteral("p99"), percentile(99.0)},
+        {QStringLiteral("p999"), percentile(99.9)}
+    };
+}
+
+void FramelessWindowStatistics::reset()
+{
+    eventsFiltered = 0;
+    hitTests = 0;
+    settingsCacheHits = 0;
+    settingsCacheMisses = 0;
+    cursorChanges = 0;
+    geometryCommits = 0;
+    commitsCoalesced = 0;
+    systemMoveResizeRequests = 0;
+    inputToCommitExcessLatency.reset();
+    configureAckLatency.reset();
+    commitsPerInteraction.reset();
+    eventFilterTime.reset();
+}
+
+QJsonObject FramelessWindowStatistics::toJson() const
+{
+    return {
+        {QStringLiteral("eventsFiltered"), static_cast<qint64>(eventsFiltered)},
+        {QStringLiteral("hitTests"), static_cast<qint64>(hitTests)},
+        {QStringLiteral("settingsCacheHits"), static_cast<qint64>(settingsCacheHits)},
+        {QStringLiteral("settingsCacheMisses"), static_cast<qint64>(settingsCacheMisses)},
+        {QStringLiteral("cursorChanges"), static_cast<qint64>(cursorChanges)},
+        {QStringLiteral("geometryCommits"), static_cast<qint64>(geometryCommits)},
+        {QStringLiteral("commitsCoalesced"), static_cast<qint64>(commitsCoalesced)},
+        {QStringLiteral("systemMoveResizeRequests"), static_cast<qint64>(systemMoveResizeRequests)},
+        {QStringLiteral("inputToCommitExcessLatencyNs"), inputToCommitExcessLatency.toJson()},
+        {QStringLiteral("configureAckLatencyNs"), configureAckLatency.toJson()},
+        {QStringLiteral("commitsPerInteraction"), commitsPerInteraction.toJson()},
+        {QStringLiteral("eventFilterTimeNs"), eventFilterTime.toJson()}
+    };
+}
+
+namespace WindowStatistics
+{
+
+std::atomic_bool g_enabled = {false};
+
+struct WindowData
+{
+    FramelessWindowStatistics statistics = {};
+    // The input timestamps come from the windowing system's clock (the X
+    // server time on X11), which has an unknown offset to ours. The smallest
+    // difference seen so far is the baseline of the excess latency.
+    qint64 clockOffset = 0;
+    bool hasClockOffset = false;
+    // The oldest geometry commit which hasn't been acknowledged yet, so the
+    // latency includes the time spent waiting behind the later ones.
+    qint64 pendingCommitTime = -1;
+    quint64 interactionCommits = 0;
+};
+
+struct WindowStatisticsData
+{
+    QHash<const QWindow *, WindowData> windows = {};
+};
+
+Q_GLOBAL_STATIC(WindowStatisticsData, g_windowStatisticsData)
+
+void setEnabled(const bool value)
+{
+    g_enabled.store(value, std::memory_order_relaxed);
+}
+
+FramelessWindowStatistics *get(const QWindow *window)
+{
+    if (!window || !isEnabled()) {
+        return nullptr;
+    }
+    return &g_windowStatisticsData()->windows[window].statistics;
+}
+
+FramelessWindowStatistics snapshot(const QWindow *window)
+{
+    if (!window) {
+        return {};
+    }
+    return g_windowStatisticsData()->windows.value(window).statistics;
+}
+
+void reset(const QWindow *window)
+{
+    if (!window) {
+        g_windowStatisticsData()->windows.clear();
+        return;
+    }
+    const auto it = g_windowStatisticsData()->windows.find(window);
+    if (it != g_windowStatisticsData()->windows.end()) {
+        it->statistics.reset();
+        it->hasClockOffset = false;
+        it->pendingCommitTime = -1;
+        it->interactionCommits = 0;
+    }
+}
+
+void remove(const QWindow *window)
+{
+    g_windowStatisticsData()->windows.remove(window);
+}
+
+[[nodiscard]] static inline const QElapsedTimer &monotonicClock()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock;
+}
+
+void recordGeometryCommit(const QWindow *window, const quint64 inputTimestamp)
+{
+    if (!window || !isEnabled()) {
+        return;
+    }
+    WindowData &data = g_windowStatisticsData()->windows[window];
+    ++data.statistics.geometryCommits;
+    ++data.interactionCommits;
+    if (data.pendingCommitTime < 0) {
+        data.pendingCommitTime = monotonicClock().nsecsElapsed();
+    }
+    if (inputTimestamp == 0) {
+        return;
+    }
+    const qint64 offset = (monotonicClock().elapsed() - static_cast<qint64>(inputTimestamp));
+    if (!data.hasClockOffset || (offset < data.clockOffset)) {
+        data.clockOffset = offset;
+        data.hasClockOffset = true;
+    }
+    data.statistics.inputToCommitExcessLatency.record((offset - data.clockOffset) * 1000000);
+}
+
+void recordGeometryAck(const QWindow *window)
+{
+    if (!window || !isEnabled()) {
+        return;
+    }
+    const auto it = g_windowStatisticsData()->windows.find(window);
+    if ((it == g_windowStatisticsData()->windows.end()) || (it->pendingCommitTime < 0)) {
+        return;
+    }
+    it->statistics.configureAckLatency.record(monotonicClock().nsecsElapsed() - it->pendingCommitTime);
+    it->pendingCommitTime = -1;
+}
+
+void recordInteractionFinished(const QWindow *window)
+{
+    if (!window || !isEnabled()) {
+        return;
+    }
+    WindowData &data = g_windowStatisticsData()->windows[window];
+    data.statistics.commitsPerInteraction.record(static_cast<qint64>(data.interactionCommits));
+    data.interactionCommits = 0;
+}
+
+EventFilterScope::EventFilterScope(const QWindow *window)
+{
+    if (!window || !isEnabled()) {
+        return;
+    }
+    m_window = window;
+    m_timer.start();
+}
+
+EventFilterScope::~EventFilterScope()
+{
+    if (!m_window) {
+        return;
+    }
+    if (FramelessWindowStatistics * const statistics = get(m_window)) {
+        ++statistics->eventsFiltered;
+        statistics->eventFilterTime.record(m_timer.nsecsElapsed());
+    }
+}
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qjsonobject.h>
+#include <array>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// A log-linear (HDR style) histogram of durations in nanoseconds. Every power
+// of two range is split into 16 linear sub-buckets, which keeps the relative
+// error below ~6% over the whole range with a fixed amount of memory and no
+// allocation when recording.
+class FRAMELESSHELPER_API LatencyHistogram
+{
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBucketCount = (1 << kSubBucketBits);
+    // Values below kSubBucketCount get one bucket each, every power of two
+    // range from there up to 2^64 gets kSubBucketCount buckets.
+    static constexpr int kBucketCount = ((64 - kSubBucketBits + 1) * kSubBucketCount);
+
+    void record(const qint64 nsecs);
+    void reset();
+
+    [[nodiscard]] quint64 count() const;
+    [[nodiscard]] qint64 min() const;
+    [[nodiscard]] qint64 max() const;
+    [[nodiscard]] qint64 mean() const;
+    // "percentile" is in the [0, 100] range.
+    [[nodiscard]] qint64 percentile(const qreal percentile) const;
+
+    [[nodiscard]] QJsonObject toJson() const;
+
+private:
+    std::array<quint64, kBucketCount> m_buckets = {};
+    quint64 m_count = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+    qint64 m_total = 0;
+};
+
+struct FRAMELESSHELPER_API FramelessWindowStatistics
+{
+    quint64 eventsFiltered = 0;
+    quint64 hitTests = 0;
+    // Events which could use the cached window settings, and events which had
+    // to read them from the window's properties again.
+    quint64 settingsCacheHits = 0;
+    quint64 settingsCacheMisses = 0;
+    quint64 cursorChanges = 0;
+    // The window's own geometry changes, the ones it gets as a member of a
+    // dragged window group aren't counted.
+    quint64 geometryCommits = 0;
+    // Geometry changes which were dropped because they wouldn't have changed anything.
+    quint64 commitsCoalesced = 0;
+    // Interactions handed over to the window manager (MoveResizeMode::System).
+    quint64 systemMoveResizeRequests = 0;
+    // How much longer than the fastest one seen (for this window) it took from
+    // QInputEvent::timestamp() to the geometry commit the event caused. The
+    // input timestamps come from the windowing system's clock, which has an
+    // unknown offset to ours, so only this excess over the best case can be
+    // measured, not the absolute latency. Millisecond resolution.
+    LatencyHistogram inputToCommitExcessLatency = {};
+    // From a geometry commit to the move/resize event which acknowledges it,
+    // that is, one configure round trip through the window manager.
+    LatencyHistogram configureAckLatency = {};
+    // Geometry commits (configure requests) per drag or resize, not a duration.
+    LatencyHistogram commitsPerInteraction = {};
+    // Time spent inside FramelessHelper::eventFilter().
+    LatencyHistogram eventFilterTime = {};
+
+    void reset();
+    [[nodiscard]] QJsonObject toJson() const;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
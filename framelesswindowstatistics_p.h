@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesswindowstatistics.h"
+#include <QtCore/qelapsedtimer.h>
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+namespace WindowStatistics
+{
+
+extern std::atomic_bool g_enabled;
+
+[[nodiscard]] inline bool isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(const bool value);
+
+// Returns nullptr if the statistics are disabled.
+[[nodiscard]] FramelessWindowStatistics *get(const QWindow *window);
+[[nodiscard]] FramelessWindowStatistics snapshot(const QWindow *window);
+void reset(const QWindow *window);
+void remove(const QWindow *window);
+
+void recordGeometryCommit(const QWindow *window, const quint64 inputTimestamp);
+// Called for the move and resize events the window receives.
+void recordGeometryAck(const QWindow *window);
+void recordInteractionFinished(const QWindow *window);
+
+// Measures the time spent in the enclosing scope.
+class EventFilterScope
+{
+    Q_DISABLE_COPY_MOVE(EventFilterScope)
+
+public:
+    explicit EventFilterScope(const QWindow *window);
+    ~EventFilterScope();
+
+private:
+    const QWindow *m_window = nullptr;
+    QElapsedTimer m_timer = {};
+};
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -15,16 +15,46 @@ HEADERS += \
     framelesshelper_global.h \
     framelesshelper.h \
     framelesswindowsmanager.h \
+    framelesswindowsmanager_p.h \
+    framelessinputrecorder.h \
+    framelesswindowstatistics.h \
+    framelesswindowstatistics_p.h \
+    framelessflightrecorder.h \
+    framelessflightrecorder_p.h \
+    framelesshelper_trace_p.h \
+    framelessliveresize_p.h \
+    framelessscreenindex_p.h \
+    framelessmagnetism_p.h \
+    framelesswindowgroup_p.h \
+    framelessscreenchange_p.h \
     utilities.h
 SOURCES += \
     framelesshelper.cpp \
     framelesswindowsmanager.cpp \
+    framelessinputrecorder.cpp \
+    framelesswindowstatistics.cpp \
+    framelessflightrecorder.cpp \
+    framelessliveresize.cpp \
+    framelessscreenindex.cpp \
+    framelessmagnetism.cpp \
+    framelesswindowgroup.cpp \
+    framelessscreenchange.cpp \
     utilities.cpp
+qtHaveModule(widgets) {
+    QT += widgets
+    DEFINES += FRAMELESSHELPER_HAS_WIDGETS
+}
 qtHaveModule(quick) {
     QT += quick
     HEADERS += framelessquickhelper.h
     SOURCES += framelessquickhelper.cpp
 }
+# qmake CONFIG+=framelesshelper_tracepoints
+framelesshelper_tracepoints {
+    TRACEPOINT_PROVIDER = $$PWD/framelesshelper.tracepoints
+    CONFIG += qt_tracepoints
+    DEFINES += FRAMELESSHELPER_HAS_TRACEPOINTS
+}
 win32 {
     HEADERS += \
         framelesshelper_windows.h \
@@ -37,5 +67,19 @@ win32 {
     LIBS += -luser32 -lshell32 -ladvapi32
     RC_FILE = framelesshelper.rc
 }
-linux*: SOURCES += utilities_linux.cpp
+linux* {
+    HEADERS += themehelper_linux_p.h
+    SOURCES += \
+        themehelper_linux.cpp \
+        utilities_linux.cpp
+    qtHaveModule(dbus) {
+        QT += dbus
+        DEFINES += FRAMELESSHELPER_HAS_DBUS
+    }
+    packagesExist(xcb) {
+        CONFIG += link_pkgconfig
+        PKGCONFIG += xcb
+        DEFINES += FRAMELESSHELPER_HAS_XCB
+    }
+}
 macx: SOURCES += utilities_macos.mm
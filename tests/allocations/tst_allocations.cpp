@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Replays hover, drag and resize mouse event streams to a frameless window
+// and checks that, once warmed up, the event filter of FramelessHelper makes
+// no heap allocation at all. Moving or resizing a window costs Qt some
+// allocations of its own (the window system events it queues), so those two
+// are compared against the same geometry changes made without the helper.
+//
+// Run it with QT_QPA_PLATFORM=offscreen (ctest does).
+
+#include <QtTest/qtest.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qwindow.h>
+#include "../shared/allocationcounter.h"
+#include "../../framelesswindowsmanager.h"
+#include <iterator>
+#include <memory>
+#include <vector>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+static const QRect kInitialGeometry = {100, 100, 300, 200};
+static constexpr int kStreamLength = 32;
+
+using MouseEvents = std::vector<std::unique_ptr<QMouseEvent>>;
+
+// Installed before the frameless helper, so it sees the mouse events right
+// after the helper and keeps them away from the window: only the allocations
+// of the helper are counted.
+class MouseEventSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MouseEventSink(QObject *parent = nullptr) : QObject(parent) {}
+
+    bool eventFilter(QObject *object, QEvent *event) override
+    {
+        Q_UNUSED(object);
+        switch (event->type()) {
+        case QEvent::MouseMove:
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+class FramelessWindow
+{
+public:
+    FramelessWindow()
+    {
+        m_window.setGeometry(kInitialGeometry);
+        m_window.installEventFilter(&m_sink);
+        FramelessWindowsManager::addWindow(&m_window);
+        m_window.show();
+    }
+
+    [[nodiscard]] QWindow *window()
+    {
+        return &m_window;
+    }
+
+    [[nodiscard]] bool isExposed()
+    {
+        return QTest::qWaitForWindowExposed(&m_window);
+    }
+
+private:
+    MouseEventSink m_sink;
+    QWindow m_window;
+};
+
+[[nodiscard]] static std::unique_ptr<QMouseEvent> mouseEvent(const QEvent::Type type, const QPoint &pos,
+                                                             const QPoint &globalPos, const Qt::MouseButton button,
+                                                             const Qt::MouseButtons buttons)
+{
+    return std::make_unique<QMouseEvent>(type, pos, pos, globalPos, button, buttons, Qt::NoModifier);
+}
+
+// A press at "pos", "kStreamLength" moves by one pixel in both directions
+// with the button held down and the release.
+[[nodiscard]] static MouseEvents pressMoveRelease(const QWindow *window, const QPoint &pos)
+{
+    const QPoint globalPos = window->mapToGlobal(pos);
+    MouseEvents events = {};
+    events.push_back(mouseEvent(QEvent::MouseButtonPress, pos, globalPos, Qt::LeftButton, Qt::LeftButton));
+    for (int i = 1; i <= kStreamLength; ++i) {
+        events.push_back(mouseEvent(QEvent::MouseMove, pos, (globalPos + QPoint(i, i)), Qt::NoButton, Qt::LeftButton));
+    }
+    const QPoint releasePos = (globalPos + QPoint(kStreamLength, kStreamLength));
+    events.push_back(mouseEvent(QEvent::MouseButtonRelease, pos, releasePos, Qt::LeftButton, Qt::NoButton));
+    return events;
+}
+
+template<typename Functor>
+[[nodiscard]] static quint64 countAllocations(Functor &&functor)
+{
+    AllocationCounter::reset();
+    AllocationCounter::resume();
+    functor();
+    AllocationCounter::pause();
+    return AllocationCounter::count();
+}
+
+// The geometry changes of the window are delivered asynchronously, they are
+// not part of what is being counted.
+static void flushWindowSystemEvents()
+{
+    QCoreApplication::processEvents();
+}
+
+class tst_Allocations : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void hover();
+    void drag();
+    void resize();
+
+private:
+    // Replays the stream of a drag or a resize and counts the allocations of
+    // its moves, except for the first one, which starts the interaction. The
+    // same geometry changes are then made by "commit" for the baseline.
+    template<typename PressPosition, typename Commit>
+    void compareWithBaseline(PressPosition &&pressPosition, Commit &&commit);
+};
+
+void tst_Allocations::hover()
+{
+    FramelessWindow frameless;
+    QVERIFY(frameless.isExposed());
+    QWindow * const window = frameless.window();
+    const int border = FramelessWindowsManager::getResizeBorderThickness(window);
+    const int titleBarHeight = FramelessWindowsManager::getTitleBarHeight(window);
+    const int width = window->width();
+    const int height = window->height();
+    // The contents, the title bar and every resize edge and corner, so that
+    // the cursor shape keeps changing as well.
+    const QPoint points[] = {
+        {width / 2, height / 2}, {width / 2, titleBarHeight / 2}, {border / 2, height / 2},
+        {width - (border / 2) - 1, height / 2}, {width / 2, border / 2}, {width / 2, height - (border / 2) - 1},
+        {border / 2, border / 2}, {width - (border / 2) - 1, height - (border / 2) - 1},
+        {width - (border / 2) - 1, border / 2}, {border / 2, height - (border / 2) - 1}
+    };
+    MouseEvents events = {};
+    for (int i = 0; i != kStreamLength; ++i) {
+        const QPoint &pos = points[i % std::size(points)];
+        events.push_back(mouseEvent(QEvent::MouseMove, pos, window->mapToGlobal(pos), Qt::NoButton, Qt::NoButton));
+    }
+    const auto sendEvents = [window, &events](){
+        for (auto &&event : events) {
+            QCoreApplication::sendEvent(window, event.get());
+        }
+    };
+    sendEvents();
+    QCOMPARE(countAllocations(sendEvents), quint64(0));
+}
+
+template<typename PressPosition, typename Commit>
+void tst_Allocations::compareWithBaseline(PressPosition &&pressPosition, Commit &&commit)
+{
+    FramelessWindow frameless;
+    QVERIFY(frameless.isExposed());
+    QWindow * const window = frameless.window();
+    const auto replay = [window](const MouseEvents &events, quint64 *allocations) {
+        QCoreApplication::sendEvent(window, events.front().get());
+        QCoreApplication::sendEvent(window, events[1].get());
+        flushWindowSystemEvents();
+        for (std::size_t i = 2; i != (events.size() - 1); ++i) {
+            *allocations += countAllocations([window, &events, i](){
+                QCoreApplication::sendEvent(window, events[i].get());
+            });
+            flushWindowSystemEvents();
+        }
+        QCoreApplication::sendEvent(window, events.back().get());
+        flushWindowSystemEvents();
+    };
+    quint64 allocations = 0;
+    // Warm up, the first interaction fills the caches.
+    replay(pressMoveRelease(window, pressPosition(window)), &allocations);
+    allocations = 0;
+    const QRect start = window->geometry();
+    replay(pressMoveRelease(window, pressPosition(window)), &allocations);
+    // Make sure the helper has actually moved (or resized) the window.
+    QVERIFY(window->geometry() != start);
+    quint64 baseline = 0;
+    for (int i = 2; i <= kStreamLength; ++i) {
+        baseline += countAllocations([window, &commit](){
+            commit(window);
+        });
+        flushWindowSystemEvents();
+    }
+    QVERIFY2(allocations <= baseline, qPrintable(QStringLiteral("%1 allocations, %2 without FramelessHelper")
+                                                 .arg(allocations).arg(baseline)));
+}
+
+void tst_Allocations::drag()
+{
+    const auto titleBar = [](const QWindow *window){
+        return QPoint(window->width() / 2, FramelessWindowsManager::getTitleBarHeight(window) / 2);
+    };
+    compareWithBaseline(titleBar, [](QWindow *window){
+        window->setPosition(window->position() + QPoint(1, 1));
+    });
+}
+
+void tst_Allocations::resize()
+{
+    const auto bottomRightCorner = [](const QWindow *window){
+        return QPoint(window->width() - 1, window->height() - 1);
+    };
+    compareWithBaseline(bottomRightCorner, [](QWindow *window){
+        window->setGeometry(window->geometry().adjusted(0, 0, 1, 1));
+    });
+}
+
+QTEST_MAIN(tst_Allocations)
+
+#include "tst_allocations.moc"
@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// A stand-in for a window manager, just good enough for finding out how the
+// frameless windows talk to one. It redirects the map and configure requests
+// of the top level windows, grants them as they are (like a window manager
+// which doesn't reparent) and advertises _NET_WM_MOVERESIZE, so that Qt hands
+// interactive moves and resizes over. Every request, _NET_WM_MOVERESIZE message
+// and property change is written to stdout as one line:
+//
+//     <CLOCK_MONOTONIC nanoseconds> <window> <what> [details]
+//
+// "ready" is written once it has become the window manager. It exits when the
+// connection to the X server is lost.
+
+#include <xcb/xcb.h>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+[[nodiscard]] static std::int64_t monotonicNanoseconds()
+{
+    timespec time = {};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((std::int64_t(time.tv_sec) * 1000000000) + std::int64_t(time.tv_nsec));
+}
+
+[[nodiscard]] static xcb_atom_t internAtom(xcb_connection_t *connection, const char *name)
+{
+    const xcb_intern_atom_cookie_t cookie = xcb_intern_atom(connection, 0, std::uint16_t(std::strlen(name)), name);
+    xcb_intern_atom_reply_t * const reply = xcb_intern_atom_reply(connection, cookie, nullptr);
+    if (!reply) {
+        return XCB_ATOM_NONE;
+    }
+    const xcb_atom_t atom = reply->atom;
+    std::free(reply);
+    return atom;
+}
+
+[[nodiscard]] static const std::string &atomName(xcb_connection_t *connection, const xcb_atom_t atom)
+{
+    static std::unordered_map<xcb_atom_t, std::string> names = {};
+    const auto it = names.find(atom);
+    if (it != names.end()) {
+        return it->second;
+    }
+    std::string name = "?";
+    const xcb_get_atom_name_cookie_t cookie = xcb_get_atom_name(connection, atom);
+    if (xcb_get_atom_name_reply_t * const reply = xcb_get_atom_name_reply(connection, cookie, nullptr)) {
+        name.assign(xcb_get_atom_name_name(reply), std::size_t(xcb_get_atom_name_name_length(reply)));
+        std::free(reply);
+    }
+    return names.emplace(atom, name).first->second;
+}
+
+static void writeLine(const std::int64_t timestamp, const xcb_window_t window, const char *format, ...)
+{
+    std::printf("%lld %u ", static_cast<long long>(timestamp), window);
+    va_list arguments;
+    va_start(arguments, format);
+    std::vprintf(format, arguments);
+    va_end(arguments);
+    std::putchar('\n');
+    std::fflush(stdout);
+}
+
+int main()
+{
+    int screenNumber = 0;
+    xcb_connection_t * const connection = xcb_connect(nullptr, &screenNumber);
+    if (xcb_connection_has_error(connection)) {
+        std::fprintf(stderr, "Failed to connect to the X server.\n");
+        return -1;
+    }
+    xcb_screen_iterator_t screens = xcb_setup_roots_iterator(xcb_get_setup(connection));
+    for (int i = 0; (i != screenNumber) && screens.rem; ++i) {
+        xcb_screen_next(&screens);
+    }
+    const xcb_window_t root = screens.data->root;
+
+    // Only one client can redirect the substructure of the root window.
+    const std::uint32_t rootEventMask = (XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY);
+    const xcb_void_cookie_t cookie = xcb_change_window_attributes_checked(connection, root, XCB_CW_EVENT_MASK, &rootEventMask);
+    if (xcb_generic_error_t * const error = xcb_request_check(connection, cookie)) {
+        std::fprintf(stderr, "Another window manager is running.\n");
+        std::free(error);
+        return -1;
+    }
+
+    const xcb_atom_t supported = internAtom(connection, "_NET_SUPPORTED");
+    const xcb_atom_t supportingWmCheck = internAtom(connection, "_NET_SUPPORTING_WM_CHECK");
+    const xcb_atom_t moveResize = internAtom(connection, "_NET_WM_MOVERESIZE");
+    const xcb_atom_t wmName = internAtom(connection, "_NET_WM_NAME");
+    const xcb_atom_t utf8String = internAtom(connection, "UTF8_STRING");
+
+    // What the EWMH expects from a compliant window manager, Qt reads it when it connects.
+    const xcb_window_t checkWindow = xcb_generate_id(connection);
+    xcb_create_window(connection, XCB_COPY_FROM_PARENT, checkWindow, root, -1, -1, 1, 1, 0,
+                      XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT, 0, nullptr);
+    xcb_change_property(connection, XCB_PROP_MODE_REPLACE, checkWindow, supportingWmCheck, XCB_ATOM_WINDOW, 32, 1, &checkWindow);
+    xcb_change_property(connection, XCB_PROP_MODE_REPLACE, root, supportingWmCheck, XCB_ATOM_WINDOW, 32, 1, &checkWindow);
+    static const char name[] = "StubWindowManager";
+    xcb_change_property(connection, XCB_PROP_MODE_REPLACE, checkWindow, wmName, utf8String, 8, std::strlen(name), name);
+    const xcb_atom_t supportedAtoms[] = {supported, supportingWmCheck, moveResize};
+    xcb_change_property(connection, XCB_PROP_MODE_REPLACE, root, supported, XCB_ATOM_ATOM, 32,
+                        (sizeof(supportedAtoms) / sizeof(supportedAtoms[0])), supportedAtoms);
+    xcb_flush(connection);
+
+    std::printf("ready\n");
+    std::fflush(stdout);
+
+    while (xcb_generic_event_t * const event = xcb_wait_for_event(connection)) {
+        // Taken before anything else, the lines are used for measuring round trips.
+        const std::int64_t timestamp = monotonicNanoseconds();
+        switch (event->response_type & ~0x80) {
+        case XCB_MAP_REQUEST: {
+            const auto request = reinterpret_cast<const xcb_map_request_event_t *>(event);
+            writeLine(timestamp, request->window, "MapRequest");
+            const std::uint32_t eventMask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+            xcb_change_window_attributes(connection, request->window, XCB_CW_EVENT_MASK, &eventMask);
+            xcb_map_window(connection, request->window);
+        } break;
+        case XCB_CONFIGURE_REQUEST: {
+            const auto request = reinterpret_cast<const xcb_configure_request_event_t *>(event);
+            writeLine(timestamp, request->window, "ConfigureRequest %d %d %u %u %u", request->x, request->y,
+                      request->width, request->height, request->value_mask);
+            // The values only contain the fields set in the mask, in this order.
+            std::uint32_t values[7] = {};
+            int count = 0;
+            if (request->value_mask & XCB_CONFIG_WINDOW_X) {
+                values[count++] = std::uint32_t(std::int32_t(request->x));
+            }
+            if (request->value_mask & XCB_CONFIG_WINDOW_Y) {
+                values[count++] = std::uint32_t(std::int32_t(request->y));
+            }
+            if (request->value_mask & XCB_CONFIG_WINDOW_WIDTH) {
+                values[count++] = request->width;
+            }
+            if (request->value_mask & XCB_CONFIG_WINDOW_HEIGHT) {
+                values[count++] = request->height;
+            }
+            if (request->value_mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) {
+                values[count++] = request->border_width;
+            }
+            if (request->value_mask & XCB_CONFIG_WINDOW_SIBLING) {
+                values[count++] = request->sibling;
+            }
+            if (request->value_mask & XCB_CONFIG_WINDOW_STACK_MODE) {
+                values[count++] = request->stack_mode;
+            }
+            xcb_configure_window(connection, request->window, request->value_mask, values);
+        } break;
+        case XCB_CONFIGURE_NOTIFY: {
+            const auto notify = reinterpret_cast<const xcb_configure_notify_event_t *>(event);
+            if (notify->window != checkWindow) {
+                writeLine(timestamp, notify->window, "ConfigureNotify %d %d %u %u", notify->x, notify->y,
+                          notify->width, notify->height);
+            }
+        } break;
+        case XCB_CLIENT_MESSAGE: {
+            const auto message = reinterpret_cast<const xcb_client_message_event_t *>(event);
+            if (message->type == moveResize) {
+                // Root position, direction (8 is a move) and button.
+                writeLine(timestamp, message->window, "MoveResize %d %d %u %u",
+                          std::int32_t(message->data.data32[0]), std::int32_t(message->data.data32[1]),
+                          message->data.data32[2], message->data.data32[3]);
+            } else {
+                writeLine(timestamp, message->window, "ClientMessage %s", atomName(connection, message->type).c_str());
+            }
+        } break;
+        case XCB_PROPERTY_NOTIFY: {
+            const auto notify = reinterpret_cast<const xcb_property_notify_event_t *>(event);
+            writeLine(timestamp, notify->window, "PropertyNotify %s %s", atomName(connection, notify->atom).c_str(),
+                      ((notify->state == XCB_PROPERTY_NEW_VALUE) ? "NewValue" : "Deleted"));
+        } break;
+        default:
+            break;
+        }
+        std::free(event);
+        xcb_flush(connection);
+    }
+
+    xcb_disconnect(connection);
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Counts the configure round trips each move and resize of a frameless window
+// causes, for every MoveResizeMode. The test runs its own Xvfb server with a
+// stand-in window manager (StubWindowManager) which logs every request it
+// gets; the number of requests per drag (or resize) comes from that log and
+// the time-to-ack (from a geometry commit to the move or resize event which
+// acknowledges it) from the window statistics. Both are printed for each mode.
+
+#include <QtTest/qtest.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qprocess.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qwindow.h>
+#include "../../framelesswindowsmanager.h"
+#include "../../framelesswindowstatistics.h"
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+static const QRect kInitialGeometry = {100, 100, 400, 300};
+static constexpr int kInteractionCount = 5;
+static constexpr int kStepCount = 20;
+static const QPoint kStepDelta = {3, 2};
+
+// Started before the application object, Qt reads what the window manager
+// supports when it connects to the X server.
+static QProcess *g_windowManager = nullptr;
+
+struct WindowManagerLog
+{
+    int configureRequests = 0;
+    int moveResizeMessages = 0;
+    int propertyChanges = 0;
+    QPoint lastRequestedPosition = {};
+    QSize lastRequestedSize = {};
+};
+
+// Takes in what the window manager has written so far about "window".
+static void readWindowManagerLog(const WId window, WindowManagerLog *log)
+{
+    Q_ASSERT(log);
+    while (g_windowManager->canReadLine()) {
+        const QList<QByteArray> fields = g_windowManager->readLine().trimmed().split(' ');
+        if ((fields.size() < 3) || (fields.at(1).toULongLong() != window)) {
+            continue;
+        }
+        const QByteArray &what = fields.at(2);
+        if ((what == "ConfigureRequest") && (fields.size() >= 8)) {
+            ++log->configureRequests;
+            const uint mask = fields.at(7).toUInt();
+            // XCB_CONFIG_WINDOW_X, Y, WIDTH and HEIGHT.
+            if (mask & 0x1) {
+                log->lastRequestedPosition.setX(fields.at(3).toInt());
+            }
+            if (mask & 0x2) {
+                log->lastRequestedPosition.setY(fields.at(4).toInt());
+            }
+            if (mask & 0x4) {
+                log->lastRequestedSize.setWidth(fields.at(5).toInt());
+            }
+            if (mask & 0x8) {
+                log->lastRequestedSize.setHeight(fields.at(6).toInt());
+            }
+        } else if (what == "MoveResize") {
+            ++log->moveResizeMessages;
+        } else if (what == "PropertyNotify") {
+            ++log->propertyChanges;
+        }
+    }
+}
+
+[[nodiscard]] static QByteArray modeName(const MoveResizeMode mode)
+{
+    return ((mode == MoveResizeMode::System) ? QByteArrayLiteral("System") : QByteArrayLiteral("Manual"));
+}
+
+class tst_Configure : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void roundTrips_data();
+    void roundTrips();
+};
+
+void tst_Configure::roundTrips_data()
+{
+    QTest::addColumn<MoveResizeMode>("mode");
+    QTest::addColumn<bool>("resize");
+    for (auto &&mode : {MoveResizeMode::Manual, MoveResizeMode::System}) {
+        QTest::newRow((modeName(mode) + " drag").constData()) << mode << false;
+        QTest::newRow((modeName(mode) + " resize").constData()) << mode << true;
+    }
+}
+
+void tst_Configure::roundTrips()
+{
+    QFETCH(MoveResizeMode, mode);
+    QFETCH(bool, resize);
+#if (QT_VERSION < QT_VERSION_CHECK(5, 15, 0))
+    if (mode == MoveResizeMode::System) {
+        QSKIP("Handing the interaction over to the window manager needs Qt 5.15.");
+    }
+#endif
+
+    QWindow window;
+    window.setGeometry(kInitialGeometry);
+    FramelessWindowsManager::addWindow(&window);
+    FramelessWindowsManager::setMoveResizeMode(&window, mode);
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    const WId winId = window.winId();
+    FramelessWindowsManager::setStatisticsEnabled(true);
+    FramelessWindowsManager::resetStatistics(&window);
+
+    WindowManagerLog log = {};
+    // Only what the interactions themselves cause is counted.
+    WindowManagerLog total = {};
+    for (int interaction = 0; interaction != kInteractionCount; ++interaction) {
+        window.setGeometry(kInitialGeometry);
+        QTRY_COMPARE(window.geometry(), kInitialGeometry);
+        QTest::qWait(50);
+        readWindowManagerLog(winId, &log);
+        const WindowManagerLog before = log;
+
+        const QPoint pressPos = (resize ? QPoint(window.width() - 2, window.height() - 2)
+            : QPoint(window.width() / 2, FramelessWindowsManager::getTitleBarHeight(&window) / 2));
+        const QPoint pressGlobalPos = window.mapToGlobal(pressPos);
+        QTest::mousePress(&window, Qt::LeftButton, Qt::NoModifier, pressPos);
+        QPoint localPos = pressPos;
+        for (int step = 1; step <= kStepCount; ++step) {
+            // The pointer moves in screen coordinates, the window may be moving underneath it.
+            localPos = (pressGlobalPos + (kStepDelta * step) - window.position());
+            QTest::mouseMove(&window, localPos);
+            QCoreApplication::processEvents();
+        }
+        QTest::mouseRelease(&window, Qt::LeftButton, Qt::NoModifier, localPos);
+
+        if (mode == MoveResizeMode::System) {
+            // The stand-in doesn't move anything, it only has to be told.
+            QTRY_VERIFY((readWindowManagerLog(winId, &log), (log.moveResizeMessages > before.moveResizeMessages)));
+        } else {
+            const QPoint delta = (kStepDelta * kStepCount);
+            const QRect expected = (resize ? kInitialGeometry.adjusted(0, 0, delta.x(), delta.y())
+                                           : kInitialGeometry.translated(delta));
+            QTRY_COMPARE(window.geometry(), expected);
+            QTRY_VERIFY((readWindowManagerLog(winId, &log), (resize ? (log.lastRequestedSize == expected.size())
+                : (log.lastRequestedPosition == expected.topLeft()))));
+            QVERIFY(log.configureRequests > before.configureRequests);
+            // Nothing that wouldn't change the geometry is sent.
+            QVERIFY((log.configureRequests - before.configureRequests) <= kStepCount);
+        }
+        total.configureRequests += (log.configureRequests - before.configureRequests);
+        total.moveResizeMessages += (log.moveResizeMessages - before.moveResizeMessages);
+        total.propertyChanges += (log.propertyChanges - before.propertyChanges);
+    }
+
+    const FramelessWindowStatistics statistics = FramelessWindowsManager::statistics(&window);
+    const LatencyHistogram &ack = statistics.configureAckLatency;
+    qInfo("%s: %.1f configure requests, %.1f _NET_WM_MOVERESIZE messages and %.1f property changes per %s",
+          QTest::currentDataTag(), (qreal(total.configureRequests) / kInteractionCount),
+          (qreal(total.moveResizeMessages) / kInteractionCount), (qreal(total.propertyChanges) / kInteractionCount),
+          (resize ? "resize" : "drag"));
+    qInfo("%s: time-to-ack p50 %lld ns, p99 %lld ns, max %lld ns (%llu acks)", QTest::currentDataTag(),
+          ack.percentile(50), ack.percentile(99), ack.max(), ack.count());
+
+    FramelessWindowsManager::setStatisticsEnabled(false);
+    FramelessWindowsManager::removeWindow(&window);
+}
+
+int main(int argc, char *argv[])
+{
+    // Xvfb picks a free display itself and writes its number to the given file descriptor.
+    QProcess xvfb;
+    xvfb.setProgram(QString::fromUtf8(XVFB_EXECUTABLE));
+    xvfb.setArguments({QStringLiteral("-displayfd"), QStringLiteral("1"), QStringLiteral("-nolisten"),
+                       QStringLiteral("tcp"), QStringLiteral("-screen"), QStringLiteral("0"),
+                       QStringLiteral("1280x1024x24")});
+    xvfb.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    xvfb.start();
+    while (!xvfb.canReadLine()) {
+        if (!xvfb.waitForReadyRead()) {
+            qCritical() << "Failed to start Xvfb:" << xvfb.errorString();
+            return -1;
+        }
+    }
+    qputenv("DISPLAY", ':' + xvfb.readLine().trimmed());
+    qputenv("QT_QPA_PLATFORM", "xcb");
+
+    QProcess windowManager;
+    windowManager.setProgram(QString::fromUtf8(STUB_WINDOW_MANAGER_EXECUTABLE));
+    windowManager.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    windowManager.start();
+    if (!windowManager.waitForReadyRead() || !windowManager.readLine().startsWith("ready")) {
+        qCritical() << "Failed to start the stand-in window manager:" << windowManager.errorString();
+        xvfb.kill();
+        xvfb.waitForFinished();
+        return -1;
+    }
+    g_windowManager = &windowManager;
+
+    int result = 0;
+    {
+        QGuiApplication application(argc, argv);
+        tst_Configure test;
+        result = QTest::qExec(&test, argc, argv);
+    }
+
+    g_windowManager = nullptr;
+    // The window manager exits as soon as the server is gone.
+    xvfb.terminate();
+    xvfb.waitForFinished();
+    if (!windowManager.waitForFinished()) {
+        windowManager.kill();
+    }
+
+    return result;
+}
+
+#include "tst_configure.moc"
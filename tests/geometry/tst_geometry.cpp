@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Utilities::calculateResizeGeometry(): every constraint on its own and the
+// combinations in which they used to undo each other.
+
+#include <QtTest/qtest.h>
+#include "../../utilities.h"
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+Q_DECLARE_METATYPE(GeometryConstraints)
+
+// What Utilities::windowGeometryConstraints() returns for a window without
+// any limits, apart from the given ones.
+[[nodiscard]] static GeometryConstraints constraints(const QSize &minimumSize = {0, 0},
+                                                    const QSize &maximumSize = {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX},
+                                                    const QSize &sizeIncrement = {0, 0}, const QSize &baseSize = {},
+                                                    const qreal aspectRatio = 0.0, const QRect &workArea = {})
+{
+    GeometryConstraints result = {};
+    result.minimumSize = minimumSize;
+    result.maximumSize = maximumSize;
+    result.sizeIncrement = sizeIncrement;
+    result.baseSize = baseSize;
+    result.aspectRatio = aspectRatio;
+    result.workArea = workArea;
+    return result;
+}
+
+[[nodiscard]] static GeometryConstraints aspectRatio(const qreal ratio, const QSize &minimumSize = {0, 0},
+                                                    const QSize &maximumSize = {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX},
+                                                    const QSize &sizeIncrement = {0, 0})
+{
+    return constraints(minimumSize, maximumSize, sizeIncrement, {}, ratio);
+}
+
+[[nodiscard]] static GeometryConstraints workArea(const QRect &rect)
+{
+    return constraints({0, 0}, {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX}, {0, 0}, {}, 0.0, rect);
+}
+
+class tst_Geometry : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void calculateResizeGeometry_data();
+    void calculateResizeGeometry();
+};
+
+void tst_Geometry::calculateResizeGeometry_data()
+{
+    QTest::addColumn<QRect>("original");
+    QTest::addColumn<int>("edges");
+    QTest::addColumn<QPoint>("delta");
+    QTest::addColumn<GeometryConstraints>("constraints");
+    QTest::addColumn<QRect>("expected");
+
+    const QRect window = {100, 100, 400, 300};
+    const int right = Qt::RightEdge;
+    const int left = Qt::LeftEdge;
+    const int bottom = Qt::BottomEdge;
+    const int topLeft = (Qt::TopEdge | Qt::LeftEdge);
+    const int bottomRight = (Qt::BottomEdge | Qt::RightEdge);
+
+    QTest::newRow("no edges") << window << 0 << QPoint(50, 50) << constraints() << window;
+    QTest::newRow("no delta") << window << bottomRight << QPoint(0, 0) << constraints() << window;
+    QTest::newRow("right") << window << right << QPoint(50, 0) << constraints() << QRect(100, 100, 450, 300);
+    QTest::newRow("left") << window << left << QPoint(-50, 0) << constraints() << QRect(50, 100, 450, 300);
+    QTest::newRow("top left") << window << topLeft << QPoint(30, 20) << constraints() << QRect(130, 120, 370, 280);
+
+    QTest::newRow("minimum") << window << bottomRight << QPoint(-390, -290)
+        << constraints({200, 150}) << QRect(100, 100, 200, 150);
+    QTest::newRow("maximum") << window << bottomRight << QPoint(500, 500)
+        << constraints({0, 0}, {600, 400}) << QRect(100, 100, 600, 400);
+
+    // The base size is the minimum size unless given.
+    QTest::newRow("increment") << window << bottomRight << QPoint(37, 23)
+        << constraints({100, 100}, {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX}, {10, 20}) << QRect(100, 100, 430, 320);
+    QTest::newRow("increment from the base size") << window << right << QPoint(37, 0)
+        << constraints({100, 100}, {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX}, {10, 20}, {5, 0}) << QRect(100, 100, 435, 300);
+    QTest::newRow("increment, minimum rounded up") << window << left << QPoint(390, 0)
+        << constraints({100, 100}, {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX}, {30, 30}, {0, 0}) << QRect(380, 100, 120, 300);
+    QTest::newRow("increment, maximum rounded down") << window << right << QPoint(500, 0)
+        << constraints({100, 100}, {555, 500}, {30, 30}, {0, 0}) << QRect(100, 100, 540, 300);
+    // Rounding up to the minimum would exceed the maximum.
+    QTest::newRow("increment, no step within the size range") << window << right << QPoint(-295, 0)
+        << constraints({100, 100}, {110, 500}, {30, 30}, {0, 0}) << QRect(100, 100, 100, 300);
+
+    const QRect wide = {100, 100, 400, 200};
+    QTest::newRow("aspect ratio, horizontal") << wide << right << QPoint(100, 0)
+        << aspectRatio(2.0) << QRect(100, 100, 500, 250);
+    QTest::newRow("aspect ratio, vertical") << wide << bottom << QPoint(0, 50)
+        << aspectRatio(2.0) << QRect(100, 100, 500, 250);
+    QTest::newRow("aspect ratio, corner following the width") << wide << bottomRight << QPoint(100, 10)
+        << aspectRatio(2.0) << QRect(100, 100, 500, 250);
+    QTest::newRow("aspect ratio, corner following the height") << wide << bottomRight << QPoint(10, 100)
+        << aspectRatio(2.0) << QRect(100, 100, 600, 300);
+    QTest::newRow("aspect ratio, top left") << wide << topLeft << QPoint(-100, -10)
+        << aspectRatio(2.0) << QRect(0, 50, 500, 250);
+    QTest::newRow("aspect ratio, maximum") << wide << right << QPoint(500, 0)
+        << aspectRatio(2.0, {0, 0}, {1000, 350}) << QRect(100, 100, 700, 350);
+    QTest::newRow("aspect ratio, minimum") << wide << right << QPoint(-350, 0)
+        << aspectRatio(2.0, {100, 100}) << QRect(100, 100, 200, 100);
+    // The increment is applied first, the ratio still holds exactly.
+    QTest::newRow("aspect ratio and increment") << wide << right << QPoint(37, 0)
+        << aspectRatio(2.0, {100, 100}, {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX}, {10, 10}) << QRect(100, 100, 430, 215);
+    // Not every constraint can be met, the size range wins.
+    QTest::newRow("aspect ratio out of the size range") << window << right << QPoint(300, 0)
+        << aspectRatio(10.0, {100, 100}, {500, 200}) << QRect(100, 100, 500, 100);
+
+    QTest::newRow("work area, right") << window << right << QPoint(1000, 0)
+        << workArea({0, 0, 800, 600}) << QRect(100, 100, 700, 300);
+    QTest::newRow("work area, top left") << window << topLeft << QPoint(-500, -500)
+        << workArea({50, 80, 800, 600}) << QRect(50, 80, 450, 320);
+    // A window which is already sticking out can't be made smaller by growing it.
+    QTest::newRow("work area, window outside of it") << QRect(600, 100, 400, 300) << right << QPoint(100, 0)
+        << workArea({0, 0, 800, 600}) << QRect(600, 100, 400, 300);
+
+    // Two screens side by side: 1920x1080 with a 40 pixels high bottom panel,
+    // and 1280x1024 (no panel) on its right. windowGeometryConstraints() uses
+    // the work area of the window's own screen, not the union of both, so the
+    // window neither crosses into the other screen nor grows under the panel
+    // or into the part of the desktop which isn't covered by any screen.
+    const QRect firstScreenWorkArea = {0, 0, 1920, 1040};
+    const QRect secondScreenWorkArea = {1920, 0, 1280, 1024};
+    QTest::newRow("work area, first of two screens") << QRect(1500, 600, 400, 400) << bottomRight << QPoint(800, 600)
+        << workArea(firstScreenWorkArea) << QRect(1500, 600, 420, 440);
+    QTest::newRow("work area, second of two screens") << QRect(2500, 500, 400, 400) << bottom << QPoint(0, 600)
+        << workArea(secondScreenWorkArea) << QRect(2500, 500, 400, 524);
+}
+
+void tst_Geometry::calculateResizeGeometry()
+{
+    QFETCH(QRect, original);
+    QFETCH(int, edges);
+    QFETCH(QPoint, delta);
+    QFETCH(GeometryConstraints, constraints);
+    QFETCH(QRect, expected);
+
+    const QRect result = Utilities::calculateResizeGeometry(original, Qt::Edges(QFlag(edges)), delta, constraints);
+    QCOMPARE(result, expected);
+    QVERIFY(result.width() >= constraints.minimumSize.width());
+    QVERIFY(result.height() >= constraints.minimumSize.height());
+    QVERIFY(result.width() <= constraints.maximumSize.width());
+    QVERIFY(result.height() <= constraints.maximumSize.height());
+}
+
+QTEST_APPLESS_MAIN(tst_Geometry)
+
+#include "tst_geometry.moc"
@@ -0,0 +1,153 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// A minimal stand-in for the settings interface of the XDG desktop portal.
+// It publishes "color-scheme" and "accent-color" in the "org.freedesktop.appearance"
+// namespace, prints "ready" once the service name is owned, and then reads one
+// command per line from stdin:
+//   color-scheme <0|1|2>
+//   accent-color <red> <green> <blue>
+// It quits when stdin is closed.
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qvariant.h>
+#include <QtDBus/qdbusconnection.h>
+#include <QtDBus/qdbusargument.h>
+#include <QtDBus/qdbusextratypes.h>
+#include <QtDBus/qdbusmetatype.h>
+#include <cstdio>
+#include <thread>
+
+using PortalSettings = QMap<QString, QVariantMap>;
+
+static const QString kPortalService = QStringLiteral("org.freedesktop.portal.Desktop");
+static const QString kPortalPath = QStringLiteral("/org/freedesktop/portal/desktop");
+static const QString kAppearanceNamespace = QStringLiteral("org.freedesktop.appearance");
+static const QString kColorSchemeKey = QStringLiteral("color-scheme");
+static const QString kAccentColorKey = QStringLiteral("accent-color");
+
+static QVariant accentColor(const double red, const double green, const double blue)
+{
+    QDBusArgument argument;
+    argument.beginStructure();
+    argument << red << green << blue;
+    argument.endStructure();
+    return QVariant::fromValue(argument);
+}
+
+class StubPortalSettings : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.portal.Settings")
+
+public:
+    explicit StubPortalSettings(QObject *parent = nullptr) : QObject(parent)
+    {
+        m_appearance.insert(kColorSchemeKey, QVariant::fromValue(uint(1)));
+        m_appearance.insert(kAccentColorKey, accentColor(0.2, 0.4, 0.6));
+    }
+
+    void setValue(const QString &key, const QVariant &value)
+    {
+        m_appearance.insert(key, value);
+        Q_EMIT SettingChanged(kAppearanceNamespace, key, QDBusVariant(value));
+    }
+
+public Q_SLOTS:
+    // Spelled out instead of using the alias, the exported signature is
+    // looked up by the name of the registered meta type.
+    QMap<QString, QVariantMap> ReadAll(const QStringList &namespaces)
+    {
+        PortalSettings result = {};
+        if (namespaces.isEmpty() || namespaces.contains(kAppearanceNamespace)) {
+            result.insert(kAppearanceNamespace, m_appearance);
+        }
+        return result;
+    }
+
+Q_SIGNALS:
+    void SettingChanged(const QString &nameSpace, const QString &key, const QDBusVariant &value);
+
+private:
+    QVariantMap m_appearance = {};
+};
+
+static void execute(StubPortalSettings *settings, const QByteArray &command)
+{
+    const QList<QByteArray> words = command.simplified().split(' ');
+    if ((words.size() == 2) && (words.at(0) == "color-scheme")) {
+        settings->setValue(kColorSchemeKey, QVariant::fromValue(words.at(1).toUInt()));
+    } else if ((words.size() == 4) && (words.at(0) == "accent-color")) {
+        settings->setValue(kAccentColorKey,
+                           accentColor(words.at(1).toDouble(), words.at(2).toDouble(), words.at(3).toDouble()));
+    } else {
+        std::fprintf(stderr, "Unknown command: %s\n", command.constData());
+    }
+}
+
+// Reading stdin blocks, so it's done on its own thread and every command is
+// handed over to the main thread, where the D-Bus object lives.
+static void readCommands(StubPortalSettings *settings)
+{
+    char line[256];
+    while (std::fgets(line, sizeof(line), stdin)) {
+        const QByteArray command(line);
+        QMetaObject::invokeMethod(settings, [settings, command](){ execute(settings, command); }, Qt::QueuedConnection);
+    }
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [](){ QCoreApplication::quit(); }, Qt::QueuedConnection);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    qDBusRegisterMetaType<PortalSettings>();
+
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        std::fprintf(stderr, "Failed to connect to the D-Bus session bus.\n");
+        return -1;
+    }
+
+    StubPortalSettings settings;
+    if (!bus.registerObject(kPortalPath, &settings,
+                            QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals)) {
+        std::fprintf(stderr, "Failed to register the portal object.\n");
+        return -1;
+    }
+    if (!bus.registerService(kPortalService)) {
+        std::fprintf(stderr, "Failed to own the portal service name.\n");
+        return -1;
+    }
+
+    std::printf("ready\n");
+    std::fflush(stdout);
+
+    std::thread reader(readCommands, &settings);
+    const int result = QCoreApplication::exec();
+    reader.join();
+    return result;
+}
+
+#include "stubportal.moc"
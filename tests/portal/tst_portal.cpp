@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QtTest/qtest.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qcolor.h>
+#include "../../utilities.h"
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+// Started before the application object so that the portal is already on the
+// bus when the library reads the initial settings.
+static QProcess *g_stubPortal = nullptr;
+
+static void sendCommand(const QByteArray &command)
+{
+    QVERIFY(g_stubPortal);
+    QVERIFY(g_stubPortal->write(command + '\n') > 0);
+    QVERIFY(g_stubPortal->waitForBytesWritten());
+}
+
+class tst_Portal : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initialSettings();
+    void colorSchemeChanged();
+    void accentColorChanged();
+    void noPreference();
+};
+
+void tst_Portal::initialSettings()
+{
+    QTRY_VERIFY(Utilities::shouldAppsUseDarkMode());
+    QTRY_COMPARE(Utilities::getColorizationArea(), ColorizationArea::All);
+    QCOMPARE(Utilities::getColorizationColor().rgba(), QColor::fromRgbF(0.2, 0.4, 0.6).rgba());
+}
+
+void tst_Portal::colorSchemeChanged()
+{
+    sendCommand("color-scheme 2");
+    QTRY_VERIFY(!Utilities::shouldAppsUseDarkMode());
+    sendCommand("color-scheme 1");
+    QTRY_VERIFY(Utilities::shouldAppsUseDarkMode());
+}
+
+void tst_Portal::accentColorChanged()
+{
+    sendCommand("accent-color 1 0 0");
+    QTRY_COMPARE(Utilities::getColorizationColor(), QColor(Qt::red));
+    QCOMPARE(Utilities::getColorizationArea(), ColorizationArea::All);
+    // Out of range values mean that the user didn't choose an accent color.
+    sendCommand("accent-color -1 -1 -1");
+    QTRY_COMPARE(Utilities::getColorizationArea(), ColorizationArea::None);
+    QCOMPARE(Utilities::getColorizationColor(), QColor(Qt::darkGray));
+}
+
+void tst_Portal::noPreference()
+{
+    sendCommand("color-scheme 0");
+    QTRY_VERIFY(!Utilities::shouldAppsUseDarkMode());
+}
+
+int main(int argc, char *argv[])
+{
+    // Keep the configuration files of the current user and of the system out
+    // of the way, the portal has to be the only source of the settings.
+    const QTemporaryDir home;
+    if (!home.isValid()) {
+        qCritical() << "Failed to create a temporary home directory.";
+        return -1;
+    }
+    const QByteArray homePath = home.path().toLocal8Bit();
+    qputenv("HOME", homePath);
+    qputenv("XDG_CONFIG_HOME", homePath + "/.config");
+    qputenv("XDG_CONFIG_DIRS", homePath + "/etc/xdg");
+    qputenv("XDG_CACHE_HOME", homePath + "/.cache");
+    qputenv("XDG_RUNTIME_DIR", homePath);
+
+    QProcess stubPortal;
+    stubPortal.setProgram(QString::fromUtf8(STUB_PORTAL_EXECUTABLE));
+    stubPortal.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    stubPortal.start();
+    if (!stubPortal.waitForReadyRead() || !stubPortal.readLine().startsWith("ready")) {
+        qCritical() << "Failed to start the stub portal:" << stubPortal.errorString();
+        return -1;
+    }
+    g_stubPortal = &stubPortal;
+
+    QGuiApplication application(argc, argv);
+
+    tst_Portal test;
+    const int result = QTest::qExec(&test, argc, argv);
+
+    stubPortal.closeWriteChannel();
+    if (!stubPortal.waitForFinished()) {
+        stubPortal.kill();
+    }
+    g_stubPortal = nullptr;
+
+    return result;
+}
+
+#include "tst_portal.moc"
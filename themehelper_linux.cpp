@@ -0,0 +1,801 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "themehelper_linux_p.h"
+#include "framelesshelper_trace_p.h"
+#include <QtCore/qdebug.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qfilesystemwatcher.h>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/qsettings.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qwindow.h>
+#ifdef FRAMELESSHELPER_HAS_XCB
+#include <QtGui/qpa/qplatformnativeinterface.h>
+#include <QtGui/qpa/qwindowsysteminterface.h>
+#include <xcb/xcb.h>
+#endif
+#ifdef FRAMELESSHELPER_HAS_DBUS
+#include <QtDBus/qdbusconnection.h>
+#include <QtDBus/qdbusmessage.h>
+#include <QtDBus/qdbuspendingcall.h>
+#include <QtDBus/qdbuspendingreply.h>
+#include <QtDBus/qdbusargument.h>
+#include <QtDBus/qdbusextratypes.h>
+#include <QtDBus/qdbusmetatype.h>
+#endif
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Theme tools usually rewrite several configuration files in a row, wait for
+// the burst to settle down before notifying anyone.
+static constexpr int kThemeChangeDebounceInterval = 300;
+
+#ifdef FRAMELESSHELPER_HAS_XCB
+static constexpr char kThemeChangedAtomName[] = "_FRAMELESSHELPER_THEME_CHANGED";
+static std::atomic<xcb_atom_t> g_themeChangedAtom = {XCB_ATOM_NONE};
+#endif
+
+#ifdef FRAMELESSHELPER_HAS_DBUS
+static const QString kPortalService = QStringLiteral("org.freedesktop.portal.Desktop");
+static const QString kPortalPath = QStringLiteral("/org/freedesktop/portal/desktop");
+static const QString kPortalSettingsInterface = QStringLiteral("org.freedesktop.portal.Settings");
+static const QString kAppearanceNamespace = QStringLiteral("org.freedesktop.appearance");
+static const QString kColorSchemeKey = QStringLiteral("color-scheme");
+static const QString kAccentColorKey = QStringLiteral("accent-color");
+
+using PortalSettings = QMap<QString, QVariantMap>;
+#endif
+
+// The whole snapshot is packed into a single 64-bit word so that it can be
+// published and read atomically without any locking:
+// bits 0-31: accent color (QRgb), bit 32: has color scheme, bit 33: dark, bit 34: has accent color,
+// bits 40-47: resize border thickness.
+static constexpr quint64 kSnapshotColorSchemeBit = (quint64(1) << 32);
+static constexpr quint64 kSnapshotDarkBit = (quint64(1) << 33);
+static constexpr quint64 kSnapshotAccentColorBit = (quint64(1) << 34);
+static constexpr int kSnapshotResizeBorderThicknessShift = 40;
+
+// What the portal told us, and what we found in the configuration files.
+// The portal always wins if it has an opinion.
+static std::atomic<quint64> g_portalSnapshot = {0};
+static std::atomic<quint64> g_probeSnapshot = {0};
+// Until the portal has answered, the portal values some other process
+// stored in the theme cache are used instead.
+static std::atomic<quint64> g_cachedPortalSnapshot = {0};
+static std::atomic_bool g_portalSettingsRead = {false};
+// Generation of the theme cache the current snapshots are based on.
+static std::atomic<quint64> g_themeCacheGeneration = {0};
+static std::atomic_bool g_started = {false};
+
+struct ThemeHelperLinuxData
+{
+    QMutex mutex;
+    QPointer<ThemeHelperLinux> instance;
+    QFuture<void> initialProbe;
+};
+
+Q_GLOBAL_STATIC(ThemeHelperLinuxData, g_themeHelperLinuxData)
+
+[[nodiscard]] static inline quint64 packSnapshot(const ThemeHelperLinux::Snapshot &snapshot)
+{
+    quint64 value = snapshot.accentColor;
+    if (snapshot.hasColorScheme) {
+        value |= kSnapshotColorSchemeBit;
+    }
+    if (snapshot.dark) {
+        value |= kSnapshotDarkBit;
+    }
+    if (snapshot.hasAccentColor) {
+        value |= kSnapshotAccentColorBit;
+    }
+    value |= (quint64(qBound(0, snapshot.resizeBorderThickness, 0xFF)) << kSnapshotResizeBorderThicknessShift);
+    return value;
+}
+
+[[nodiscard]] static inline ThemeHelperLinux::Snapshot unpackSnapshot(const quint64 value)
+{
+    ThemeHelperLinux::Snapshot snapshot = {};
+    snapshot.hasColorScheme = (value & kSnapshotColorSchemeBit);
+    snapshot.dark = (value & kSnapshotDarkBit);
+    snapshot.hasAccentColor = (value & kSnapshotAccentColorBit);
+    snapshot.accentColor = static_cast<QRgb>(value & 0xFFFFFFFF);
+    snapshot.resizeBorderThickness = static_cast<int>((value >> kSnapshotResizeBorderThicknessShift) & 0xFF);
+    return snapshot;
+}
+
+[[nodiscard]] static inline int resizeBorderThicknessFromKWin(const QString &borderSize)
+{
+    // Rough equivalents of the KDecoration2 border sizes, "Normal"
+    // matches our own default value.
+    if (borderSize == QStringLiteral("Tiny")) {
+        return 4;
+    } else if (borderSize == QStringLiteral("Large")) {
+        return 10;
+    } else if (borderSize == QStringLiteral("VeryLarge")) {
+        return 12;
+    } else if (borderSize == QStringLiteral("Huge")) {
+        return 18;
+    } else if (borderSize == QStringLiteral("VeryHuge")) {
+        return 27;
+    } else if (borderSize == QStringLiteral("Oversized")) {
+        return 40;
+    }
+    return 0;
+}
+
+[[nodiscard]] static inline QStringList themeConfigFilePaths()
+{
+    const QString configDir = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation);
+    const QString homeDir = QDir::homePath();
+    return {
+        configDir + QStringLiteral("/gtk-3.0/settings.ini"),
+        configDir + QStringLiteral("/gtk-4.0/settings.ini"),
+        configDir + QStringLiteral("/kdeglobals"),
+        configDir + QStringLiteral("/kwinrc"),
+        homeDir + QStringLiteral("/.gtkrc-2.0"),
+        homeDir + QStringLiteral("/.Xresources")
+    };
+}
+
+[[nodiscard]] static inline qint64 fileTimestamp(const QString &filePath)
+{
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return -1;
+    }
+    return fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+// The probe result is shared with the other processes of the same user
+// through a small binary file in $XDG_RUNTIME_DIR, which is memory mapped
+// and used as is if none of the source files has been modified since it
+// was written. This saves every short-lived process from parsing the
+// configuration files again.
+// The portal values have no file whose timestamp could tell the other
+// processes they changed, so every rewrite bumps the generation of the
+// cache instead: a process which finds a generation it hasn't seen yet
+// knows that its own snapshot is stale. The cache file is watched just
+// like the configuration files for that reason.
+static constexpr quint32 kThemeCacheMagic = 0x43544846; // "FHTC"
+static constexpr quint32 kThemeCacheVersion = 2;
+static constexpr int kThemeCacheMaxSources = 8;
+
+struct ThemeCache
+{
+    quint32 magic;
+    quint32 version;
+    // Incremented by every process which rewrites the cache.
+    quint64 generation;
+    // Hash of the source file paths and the desktop environment, the
+    // probe result depends on both.
+    quint64 environmentHash;
+    quint32 sourceCount;
+    quint32 reserved;
+    qint64 sourceTimestamps[kThemeCacheMaxSources];
+    quint64 snapshot;
+    quint64 portalSnapshot;
+    // FNV-1a hash of all the fields above.
+    quint64 checksum;
+};
+static_assert(std::is_trivially_copyable_v<ThemeCache>);
+
+[[nodiscard]] static inline quint64 fnv1aHash(const void *data, const size_t size)
+{
+    quint64 hash = 0xcbf29ce484222325;
+    const auto bytes = static_cast<const uchar *>(data);
+    for (size_t i = 0; i != size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+[[nodiscard]] static inline quint64 themeCacheChecksum(const ThemeCache &cache)
+{
+    return fnv1aHash(&cache, offsetof(ThemeCache, checksum));
+}
+
+[[nodiscard]] static inline QString themeCacheFilePath()
+{
+    const QString runtimeDir = QString::fromLocal8Bit(qgetenv("XDG_RUNTIME_DIR"));
+    if (runtimeDir.isEmpty()) {
+        return {};
+    }
+    return runtimeDir + QStringLiteral("/framelesshelper-theme.cache");
+}
+
+[[nodiscard]] static inline quint64 themeEnvironmentHash(const QStringList &sourceFilePaths)
+{
+    const QByteArray environment = sourceFilePaths.join(QLatin1Char('\n')).toUtf8() + '\n' + qgetenv("XDG_CURRENT_DESKTOP");
+    return fnv1aHash(environment.constData(), size_t(environment.size()));
+}
+
+// Returns false if the file doesn't exist or isn't a valid theme cache.
+[[nodiscard]] static bool readThemeCache(const QString &filePath, ThemeCache *cache)
+{
+    Q_ASSERT(cache);
+    if (!cache) {
+        return false;
+    }
+    QFile file(filePath);
+    if ((file.size() != qint64(sizeof(ThemeCache))) || !file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const uchar * const data = file.map(0, sizeof(ThemeCache));
+    if (!data) {
+        return false;
+    }
+    std::memcpy(cache, data, sizeof(ThemeCache));
+    file.unmap(const_cast<uchar *>(data));
+    return ((cache->magic == kThemeCacheMagic) && (cache->version == kThemeCacheVersion)
+            && (cache->checksum == themeCacheChecksum(*cache)));
+}
+
+// Whether the probe result stored in the cache is still valid.
+[[nodiscard]] static bool isThemeCacheUpToDate(const ThemeCache &cache, const quint64 environmentHash,
+                                               const QVector<qint64> &sourceTimestamps)
+{
+    if ((cache.environmentHash != environmentHash) || (cache.sourceCount != quint32(sourceTimestamps.size()))) {
+        return false;
+    }
+    for (int i = 0; i != sourceTimestamps.size(); ++i) {
+        if (cache.sourceTimestamps[i] != sourceTimestamps.at(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void writeThemeCache(const QString &filePath, const quint64 environmentHash,
+                            const QVector<qint64> &sourceTimestamps,
+                            const quint64 snapshot, const quint64 portalSnapshot, const quint64 generation)
+{
+    ThemeCache cache = {};
+    cache.magic = kThemeCacheMagic;
+    cache.version = kThemeCacheVersion;
+    cache.generation = generation;
+    cache.environmentHash = environmentHash;
+    cache.sourceCount = quint32(sourceTimestamps.size());
+    for (int i = 0; i != sourceTimestamps.size(); ++i) {
+        cache.sourceTimestamps[i] = sourceTimestamps.at(i);
+    }
+    cache.snapshot = snapshot;
+    cache.portalSnapshot = portalSnapshot;
+    cache.checksum = themeCacheChecksum(cache);
+    // Replace the file atomically, the processes which still have the old
+    // one mapped keep seeing consistent data.
+    QSaveFile file(filePath);
+    if (!file.open(QFile::WriteOnly)) {
+        return;
+    }
+    file.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+    if (file.write(reinterpret_cast<const char *>(&cache), sizeof(cache)) != qint64(sizeof(cache))) {
+        file.cancelWriting();
+        return;
+    }
+    if (!file.commit()) {
+        qDebug() << "Failed to write the theme cache:" << file.errorString();
+    }
+}
+
+[[nodiscard]] static quint64 probeWithCache()
+{
+    const QStringList sourceFilePaths = themeConfigFilePaths();
+    Q_ASSERT(sourceFilePaths.size() <= kThemeCacheMaxSources);
+    FRAMELESSHELPER_TRACE(themeProbe_entry, sourceFilePaths.size());
+    const QString cacheFilePath = themeCacheFilePath();
+    if (cacheFilePath.isEmpty() || (sourceFilePaths.size() > kThemeCacheMaxSources)) {
+        const quint64 snapshot = packSnapshot(ThemeHelperLinux::probe());
+        FRAMELESSHELPER_TRACE(themeProbe_exit, 0, ((snapshot & kSnapshotDarkBit) ? 1 : 0));
+        return snapshot;
+    }
+    QVector<qint64> sourceTimestamps = {};
+    sourceTimestamps.reserve(sourceFilePaths.size());
+    for (auto &&filePath : qAsConst(sourceFilePaths)) {
+        sourceTimestamps.append(fileTimestamp(filePath));
+    }
+    const quint64 environmentHash = themeEnvironmentHash(sourceFilePaths);
+    const bool portalSettingsRead = g_portalSettingsRead.load(std::memory_order_acquire);
+    const quint64 portalSnapshot = g_portalSnapshot.load(std::memory_order_acquire);
+    ThemeCache cache = {};
+    const bool cacheValid = readThemeCache(cacheFilePath, &cache);
+    if (cacheValid && (cache.generation != g_themeCacheGeneration.load(std::memory_order_acquire))) {
+        // Rewritten by some other process since we last looked at it.
+        g_cachedPortalSnapshot.store(cache.portalSnapshot, std::memory_order_release);
+        g_themeCacheGeneration.store(cache.generation, std::memory_order_release);
+    }
+    if (cacheValid && isThemeCacheUpToDate(cache, environmentHash, sourceTimestamps)) {
+        if (portalSettingsRead && (portalSnapshot != cache.portalSnapshot)) {
+            // The portal told us about a change the cache doesn't know yet,
+            // let the other processes know as well.
+            writeThemeCache(cacheFilePath, environmentHash, sourceTimestamps,
+                            cache.snapshot, portalSnapshot, cache.generation + 1);
+            g_themeCacheGeneration.store(cache.generation + 1, std::memory_order_release);
+        }
+        FRAMELESSHELPER_TRACE(themeProbe_exit, 1, ((cache.snapshot & kSnapshotDarkBit) ? 1 : 0));
+        return cache.snapshot;
+    }
+    // Stale, corrupted or missing: probe for real and share the result.
+    const quint64 snapshot = packSnapshot(ThemeHelperLinux::probe());
+    const quint64 generation = ((cacheValid ? cache.generation : 0) + 1);
+    writeThemeCache(cacheFilePath, environmentHash, sourceTimestamps, snapshot,
+                    (portalSettingsRead ? portalSnapshot : (cacheValid ? cache.portalSnapshot : 0)), generation);
+    g_themeCacheGeneration.store(generation, std::memory_order_release);
+    FRAMELESSHELPER_TRACE(themeProbe_exit, 0, ((snapshot & kSnapshotDarkBit) ? 1 : 0));
+    return snapshot;
+}
+
+class ThemeProbeRunnable : public QRunnable
+{
+public:
+    explicit ThemeProbeRunnable(const QFutureInterface<void> &futureInterface)
+        : m_futureInterface(futureInterface) {}
+    ~ThemeProbeRunnable() override = default;
+
+    void run() override
+    {
+        g_probeSnapshot.store(probeWithCache(), std::memory_order_release);
+        m_futureInterface.reportFinished();
+    }
+
+private:
+    QFutureInterface<void> m_futureInterface;
+};
+
+[[nodiscard]] static inline QFuture<void> runThemeProbe()
+{
+    QFutureInterface<void> futureInterface;
+    futureInterface.reportStarted();
+    const QFuture<void> future = futureInterface.future();
+    QThreadPool::globalInstance()->start(new ThemeProbeRunnable(futureInterface));
+    return future;
+}
+
+
+ThemeHelperLinux::ThemeHelperLinux(QObject *parent) : QObject(parent) {}
+
+ThemeHelperLinux::~ThemeHelperLinux() = default;
+
+ThemeHelperLinux *ThemeHelperLinux::instance()
+{
+    QCoreApplication * const app = QCoreApplication::instance();
+    if (!app) {
+        return nullptr;
+    }
+    ThemeHelperLinuxData * const data = g_themeHelperLinuxData();
+    QMutexLocker locker(&data->mutex);
+    if (data->instance.isNull()) {
+        // The helper is parented to the application object so that it lives in
+        // the main thread (which runs the event loop the D-Bus replies are
+        // delivered to) and goes away together with the D-Bus connection.
+        const auto helper = new ThemeHelperLinux;
+        helper->moveToThread(app->thread());
+        helper->setParent(app);
+        data->instance = helper;
+        // Don't wait for the event loop, the sooner the probe starts the more
+        // likely it has finished before the first window is shown.
+        data->initialProbe = runThemeProbe();
+        helper->m_probeFuture = data->initialProbe;
+        QMetaObject::invokeMethod(helper, "initialize", Qt::QueuedConnection);
+    }
+    return data->instance.data();
+}
+
+ThemeHelperLinux::Snapshot ThemeHelperLinux::snapshot()
+{
+    if (!g_started.load(std::memory_order_acquire)) {
+        g_started.store(instance() != nullptr, std::memory_order_release);
+    }
+    const bool portalSettingsRead = g_portalSettingsRead.load(std::memory_order_acquire);
+    const Snapshot portal = unpackSnapshot((portalSettingsRead ? g_portalSnapshot : g_cachedPortalSnapshot).load(std::memory_order_acquire));
+    Snapshot snapshot = unpackSnapshot(g_probeSnapshot.load(std::memory_order_acquire));
+    if (portal.hasColorScheme) {
+        snapshot.hasColorScheme = true;
+        snapshot.dark = portal.dark;
+    }
+    if (portal.hasAccentColor) {
+        snapshot.hasAccentColor = true;
+        snapshot.accentColor = portal.accentColor;
+    }
+    return snapshot;
+}
+
+QFuture<void> ThemeHelperLinux::initialProbe()
+{
+    if (!instance()) {
+        return {};
+    }
+    ThemeHelperLinuxData * const data = g_themeHelperLinuxData();
+    QMutexLocker locker(&data->mutex);
+    return data->initialProbe;
+}
+
+bool ThemeHelperLinux::isInitialProbeHandled() const
+{
+    return m_initialProbeHandled;
+}
+
+ThemeHelperLinux::Snapshot ThemeHelperLinux::probe()
+{
+    Snapshot snapshot = {};
+    const QString configDir = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation);
+    const auto probeGtk = [&snapshot, &configDir]() -> bool {
+        for (auto &&fileName : {QStringLiteral("/gtk-4.0/settings.ini"), QStringLiteral("/gtk-3.0/settings.ini")}) {
+            const QString filePath = configDir + fileName;
+            if (!QFileInfo::exists(filePath)) {
+                continue;
+            }
+            QSettings settings(filePath, QSettings::IniFormat);
+            settings.beginGroup(QStringLiteral("Settings"));
+            const QString preferDarkTheme = QStringLiteral("gtk-application-prefer-dark-theme");
+            if (settings.contains(preferDarkTheme)) {
+                snapshot.hasColorScheme = true;
+                snapshot.dark = settings.value(preferDarkTheme).toBool();
+                return true;
+            }
+            const QString themeName = settings.value(QStringLiteral("gtk-theme-name")).toString();
+            if (!themeName.isEmpty()) {
+                snapshot.hasColorScheme = true;
+                snapshot.dark = themeName.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+                return true;
+            }
+        }
+        return false;
+    };
+    const auto probeKde = [&snapshot, &configDir]() -> bool {
+        const QString filePath = configDir + QStringLiteral("/kdeglobals");
+        if (!QFileInfo::exists(filePath)) {
+            return false;
+        }
+        QSettings settings(filePath, QSettings::IniFormat);
+        settings.beginGroup(QStringLiteral("General"));
+        // "r,g,b" is parsed as a string list by QSettings.
+        const QStringList accentColor = settings.value(QStringLiteral("AccentColor")).toStringList();
+        if (accentColor.size() == 3) {
+            snapshot.hasAccentColor = true;
+            snapshot.accentColor = qRgb(accentColor.at(0).toInt(), accentColor.at(1).toInt(), accentColor.at(2).toInt());
+        }
+        const QString colorScheme = settings.value(QStringLiteral("ColorScheme")).toString();
+        if (colorScheme.isEmpty()) {
+            return false;
+        }
+        snapshot.hasColorScheme = true;
+        snapshot.dark = colorScheme.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+        return true;
+    };
+    const bool isKde = QString::fromLocal8Bit(qgetenv("XDG_CURRENT_DESKTOP")).contains(QStringLiteral("KDE"), Qt::CaseInsensitive);
+    if (isKde) {
+        if (!probeKde()) {
+            probeGtk();
+        }
+        const QString kwinrc = configDir + QStringLiteral("/kwinrc");
+        if (QFileInfo::exists(kwinrc)) {
+            QSettings settings(kwinrc, QSettings::IniFormat);
+            settings.beginGroup(QStringLiteral("org.kde.kdecoration2"));
+            snapshot.resizeBorderThickness = resizeBorderThicknessFromKWin(settings.value(QStringLiteral("BorderSize")).toString());
+        }
+    } else {
+        if (!probeGtk()) {
+            probeKde();
+        }
+    }
+    return snapshot;
+}
+
+bool ThemeHelperLinux::isThemeChangedEvent(const void *data)
+{
+    Q_ASSERT(data);
+    if (!data) {
+        return false;
+    }
+#ifdef FRAMELESSHELPER_HAS_XCB
+    const xcb_atom_t atom = g_themeChangedAtom.load(std::memory_order_acquire);
+    if (atom == XCB_ATOM_NONE) {
+        return false;
+    }
+    const auto event = static_cast<const xcb_generic_event_t *>(data);
+    if ((event->response_type & ~0x80) != XCB_CLIENT_MESSAGE) {
+        return false;
+    }
+    const auto clientMessage = static_cast<const xcb_client_message_event_t *>(data);
+    return (clientMessage->type == atom);
+#else
+    return false;
+#endif
+}
+
+void ThemeHelperLinux::initialize()
+{
+    m_debounceTimer = new QTimer(this);
+    m_debounceTimer->setSingleShot(true);
+    m_debounceTimer->setInterval(kThemeChangeDebounceInterval);
+    connect(m_debounceTimer, &QTimer::timeout, this, &ThemeHelperLinux::startProbe);
+    m_probeWatcher = new QFutureWatcher<void>(this);
+    connect(m_probeWatcher, &QFutureWatcher<void>::finished, this, &ThemeHelperLinux::handleProbeFinished);
+    // Emits "finished" right away if the initial probe is already done.
+    m_probeWatcher->setFuture(m_probeFuture);
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &ThemeHelperLinux::handleConfigFileChanged);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &ThemeHelperLinux::handleConfigFileChanged);
+    watchConfigFiles();
+#ifdef FRAMELESSHELPER_HAS_XCB
+    if (QGuiApplication::platformName() == QStringLiteral("xcb")) {
+        const auto connection = static_cast<xcb_connection_t *>(QGuiApplication::platformNativeInterface()
+                                    ->nativeResourceForIntegration(QByteArrayLiteral("connection")));
+        if (connection) {
+            const xcb_intern_atom_cookie_t cookie = xcb_intern_atom(connection, false,
+                                                        static_cast<uint16_t>(qstrlen(kThemeChangedAtomName)), kThemeChangedAtomName);
+            xcb_intern_atom_reply_t * const reply = xcb_intern_atom_reply(connection, cookie, nullptr);
+            if (reply) {
+                g_themeChangedAtom.store(reply->atom, std::memory_order_release);
+                std::free(reply);
+            }
+        }
+    }
+#endif
+#ifdef FRAMELESSHELPER_HAS_DBUS
+    qDBusRegisterMetaType<PortalSettings>();
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        qWarning() << "Failed to connect to the D-Bus session bus.";
+        return;
+    }
+    // Subscribe before the initial read so that we can't miss a change
+    // which happens in between.
+    if (!bus.connect(kPortalService, kPortalPath, kPortalSettingsInterface, QStringLiteral("SettingChanged"),
+                     this, SLOT(handleSettingChanged(QString, QString, QDBusVariant)))) {
+        qWarning() << "Failed to subscribe to the XDG desktop portal setting changes.";
+    }
+    readSettings();
+#endif
+}
+
+void ThemeHelperLinux::watchConfigFiles()
+{
+    Q_ASSERT(m_watcher);
+    if (!m_watcher) {
+        return;
+    }
+    const QStringList watchedFiles = m_watcher->files();
+    const QStringList watchedDirectories = m_watcher->directories();
+    QStringList paths = {};
+    QStringList filePaths = themeConfigFilePaths();
+    // Rewritten by the other processes when the portal values change.
+    const QString cacheFilePath = themeCacheFilePath();
+    if (!cacheFilePath.isEmpty()) {
+        filePaths.append(cacheFilePath);
+    }
+    for (auto &&filePath : qAsConst(filePaths)) {
+        // Most tools save the files by writing a temporary file and renaming it
+        // over the original one, which drops the inotify watch of the old file,
+        // so the parent directories are watched as well to catch that.
+        const QString dirPath = QFileInfo(filePath).absolutePath();
+        if (!watchedDirectories.contains(dirPath) && !paths.contains(dirPath) && QFileInfo::exists(dirPath)) {
+            paths.append(dirPath);
+        }
+        if (!watchedFiles.contains(filePath) && QFileInfo::exists(filePath)) {
+            paths.append(filePath);
+        }
+        if (!m_configFileTimestamps.contains(filePath)) {
+            m_configFileTimestamps.insert(filePath, fileTimestamp(filePath));
+        }
+    }
+    if (!paths.isEmpty()) {
+        m_watcher->addPaths(paths);
+    }
+}
+
+void ThemeHelperLinux::handleConfigFileChanged()
+{
+    // The watched directories also report changes of unrelated files, only
+    // the files we are interested in are taken into account.
+    bool changed = false;
+    for (auto it = m_configFileTimestamps.begin(); it != m_configFileTimestamps.end(); ++it) {
+        const qint64 timestamp = fileTimestamp(it.key());
+        if (timestamp != it.value()) {
+            it.value() = timestamp;
+            changed = true;
+        }
+    }
+    watchConfigFiles();
+    if (changed) {
+        m_debounceTimer->start();
+    }
+}
+
+void ThemeHelperLinux::startProbe()
+{
+    if (m_probeWatcher->isRunning()) {
+        m_probePending = true;
+        return;
+    }
+    m_probeFuture = runThemeProbe();
+    m_probeWatcher->setFuture(m_probeFuture);
+}
+
+void ThemeHelperLinux::handleProbeFinished()
+{
+    // The very first probe is compared against the default values, so the
+    // windows created before it finished get the real values in one batch.
+    // The portal values taken from the theme cache may have changed as well.
+    const quint64 result = packSnapshot(snapshot());
+    const bool changed = (result != m_lastSnapshot);
+    m_lastSnapshot = result;
+    if (changed || m_notifyPending) {
+        m_notifyPending = false;
+        notifyThemeChanged();
+    }
+    m_initialProbeHandled = true;
+    Q_EMIT probeFinished();
+    if (m_probePending) {
+        m_probePending = false;
+        startProbe();
+    }
+}
+
+void ThemeHelperLinux::notifyThemeChanged()
+{
+    Q_EMIT themeChanged();
+    QWindowList windows = {};
+    const QWindowList topLevelWindows = QGuiApplication::topLevelWindows();
+    for (auto &&window : qAsConst(topLevelWindows)) {
+        if (window && window->handle() && window->property(Constants::kFramelessModeFlag).toBool()) {
+            windows.append(window);
+        }
+    }
+    if (windows.isEmpty()) {
+        return;
+    }
+#ifdef FRAMELESSHELPER_HAS_XCB
+    const xcb_atom_t atom = g_themeChangedAtom.load(std::memory_order_acquire);
+    if (atom != XCB_ATOM_NONE) {
+        // Deliver the notification through the native event path (just like
+        // WM_THEMECHANGED on Windows), so that Utilities::isThemeChanged() can
+        // recognize it in the windows' nativeEvent(). The message never goes
+        // through the X server: it's handed to the windows directly, so windows
+        // which don't care about it don't get an unknown client message either.
+        for (auto &&window : qAsConst(windows)) {
+            xcb_client_message_event_t event = {};
+            event.response_type = XCB_CLIENT_MESSAGE;
+            event.format = 32;
+            event.window = static_cast<xcb_window_t>(window->winId());
+            event.type = atom;
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+            qintptr result = 0;
+#else
+            long result = 0;
+#endif
+            QWindowSystemInterface::handleNativeEvent(window, QByteArrayLiteral("xcb_generic_event_t"), &event, &result);
+        }
+        return;
+    }
+#endif
+    // Without X11 there's no native event we could use, fall back to the
+    // regular theme change event.
+    for (auto &&window : qAsConst(windows)) {
+        QEvent event(QEvent::ThemeChange);
+        QCoreApplication::sendEvent(window, &event);
+    }
+}
+
+#ifdef FRAMELESSHELPER_HAS_DBUS
+void ThemeHelperLinux::readSettings()
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(kPortalService, kPortalPath,
+                                   kPortalSettingsInterface, QStringLiteral("ReadAll"));
+    message << QStringList{kAppearanceNamespace};
+    const QDBusPendingCall call = QDBusConnection::sessionBus().asyncCall(message);
+    const auto watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &ThemeHelperLinux::handleReadAllFinished);
+}
+
+void ThemeHelperLinux::handleReadAllFinished(QDBusPendingCallWatcher *watcher)
+{
+    Q_ASSERT(watcher);
+    if (!watcher) {
+        return;
+    }
+    const QDBusPendingReply<PortalSettings> reply = *watcher;
+    watcher->deleteLater();
+    if (reply.isError()) {
+        // Not an error in general: there may simply be no portal running.
+        qDebug() << "Failed to read the XDG desktop portal settings:" << reply.error().message();
+        return;
+    }
+    const QVariantMap settings = reply.value().value(kAppearanceNamespace);
+    for (auto it = settings.constBegin(); it != settings.constEnd(); ++it) {
+        updateSetting(it.key(), it.value());
+    }
+    // From now on our own portal values win over the cached ones.
+    g_portalSettingsRead.store(true, std::memory_order_release);
+    m_debounceTimer->start();
+}
+
+void ThemeHelperLinux::handleSettingChanged(const QString &nameSpace, const QString &key, const QDBusVariant &value)
+{
+    if (nameSpace != kAppearanceNamespace) {
+        return;
+    }
+    updateSetting(key, value.variant());
+}
+
+void ThemeHelperLinux::updateSetting(const QString &key, const QVariant &value)
+{
+    // Older portals wrap the value in one more variant layer.
+    QVariant var = value;
+    while (var.userType() == qMetaTypeId<QDBusVariant>()) {
+        var = qvariant_cast<QDBusVariant>(var).variant();
+    }
+    const quint64 oldValue = g_portalSnapshot.load(std::memory_order_acquire);
+    Snapshot snapshot = unpackSnapshot(oldValue);
+    if (key == kColorSchemeKey) {
+        // 0: no preference, 1: prefer dark appearance, 2: prefer light appearance.
+        const uint colorScheme = var.toUInt();
+        snapshot.hasColorScheme = (colorScheme != 0);
+        snapshot.dark = (colorScheme == 1);
+    } else if (key == kAccentColorKey) {
+        // The accent color is a (ddd) structure of sRGB values in the [0, 1] range,
+        // out of range values mean "no accent color".
+        if (var.userType() != qMetaTypeId<QDBusArgument>()) {
+            return;
+        }
+        const auto argument = qvariant_cast<QDBusArgument>(var);
+        double red = -1.0, green = -1.0, blue = -1.0;
+        argument.beginStructure();
+        argument >> red >> green >> blue;
+        argument.endStructure();
+        const auto inRange = [](const double channel) { return ((channel >= 0.0) && (channel <= 1.0)); };
+        snapshot.hasAccentColor = (inRange(red) && inRange(green) && inRange(blue));
+        snapshot.accentColor = (snapshot.hasAccentColor ? QColor::fromRgbF(red, green, blue).rgba() : 0);
+    } else {
+        return;
+    }
+    const quint64 newValue = packSnapshot(snapshot);
+    if (newValue == oldValue) {
+        return;
+    }
+    g_portalSnapshot.store(newValue, std::memory_order_release);
+    m_notifyPending = true;
+    m_debounceTimer->start();
+}
+#endif
+
+FRAMELESSHELPER_END_NAMESPACE
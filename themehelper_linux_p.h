@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qfuturewatcher.h>
+#include <QtGui/qcolor.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QTimer)
+QT_FORWARD_DECLARE_CLASS(QFileSystemWatcher)
+#ifdef FRAMELESSHELPER_HAS_DBUS
+QT_FORWARD_DECLARE_CLASS(QDBusVariant)
+QT_FORWARD_DECLARE_CLASS(QDBusPendingCallWatcher)
+#endif
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Tracks the desktop appearance settings published by the XDG desktop portal
+// (the "org.freedesktop.appearance" namespace). The settings are read once
+// asynchronously and then kept up to date from the portal's "SettingChanged"
+// signal, the result is stored in an atomic snapshot so that the getters can
+// be called from any thread without locking.
+// The GTK, KDE and X resources configuration files are watched as well, bursts
+// of changes (theme tools tend to rewrite several files in a row) are
+// debounced into a single theme change notification which is delivered to
+// all frameless windows in one go.
+// The configuration files themselves are parsed on a worker thread (the
+// "probe"), which is started as soon as the helper is created so that the
+// GUI thread never has to wait for it. The result is cached in
+// $XDG_RUNTIME_DIR and shared with the other processes.
+class ThemeHelperLinux : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(ThemeHelperLinux)
+
+public:
+    struct Snapshot
+    {
+        bool hasColorScheme = false;
+        bool dark = false;
+        bool hasAccentColor = false;
+        QRgb accentColor = 0;
+        int resizeBorderThickness = 0; // 0 means "use the default value".
+    };
+
+    explicit ThemeHelperLinux(QObject *parent = nullptr);
+    ~ThemeHelperLinux() override;
+
+    // Makes sure the helper exists and the initial read has been issued.
+    // Returns nullptr if there is no application instance yet.
+    static ThemeHelperLinux *instance();
+
+    [[nodiscard]] static Snapshot snapshot();
+    [[nodiscard]] static bool isThemeChangedEvent(const void *data);
+
+    // Reads the GTK/KDE configuration files synchronously, thread-safe.
+    [[nodiscard]] static Snapshot probe();
+    // The probe started when the helper was created.
+    [[nodiscard]] static QFuture<void> initialProbe();
+    // Whether probeFinished() has been emitted for the initial probe already.
+    [[nodiscard]] bool isInitialProbeHandled() const;
+
+Q_SIGNALS:
+    void themeChanged();
+    void probeFinished();
+
+private Q_SLOTS:
+    void initialize();
+    void handleConfigFileChanged();
+    void notifyThemeChanged();
+    void startProbe();
+    void handleProbeFinished();
+#ifdef FRAMELESSHELPER_HAS_DBUS
+    void readSettings();
+    void handleReadAllFinished(QDBusPendingCallWatcher *watcher);
+    void handleSettingChanged(const QString &nameSpace, const QString &key, const QDBusVariant &value);
+#endif
+
+private:
+#ifdef FRAMELESSHELPER_HAS_DBUS
+    void updateSetting(const QString &key, const QVariant &value);
+#endif
+    void watchConfigFiles();
+
+private:
+    QFileSystemWatcher *m_watcher = nullptr;
+    QTimer *m_debounceTimer = nullptr;
+    QHash<QString, qint64> m_configFileTimestamps = {};
+    QFuture<void> m_probeFuture = {};
+    QFutureWatcher<void> *m_probeWatcher = nullptr;
+    quint64 m_lastSnapshot = 0;
+    bool m_probePending = false;
+    bool m_notifyPending = false;
+    bool m_initialProbeHandled = false;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -23,9 +23,12 @@
  */
 
 #include "utilities.h"
+#include "framelessscreenindex_p.h"
 #include <QtCore/qdebug.h>
 #include <QtCore/qvariant.h>
+#include <QtCore/qmath.h>
 #include <QtGui/qguiapplication.h>
+#include <QtGui/qscreen.h>
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
@@ -74,11 +77,21 @@ bool Utilities::isHitTestVisible(const QWindow *window)
     if (!window) {
         return false;
     }
-    const auto objs = qvariant_cast<QObjectList>(window->property(Constants::kHitTestVisibleFlag));
-    if (objs.isEmpty()) {
+    return isHitTestVisible(window, QCursor::pos(window->screen()));
+}
+
+bool Utilities::isHitTestVisible(const QWindow *window, const QPointF &globalPos)
+{
+    Q_ASSERT(window);
+    if (!window) {
         return false;
     }
-    for (auto &&obj : qAsConst(objs)) {
+    return isHitTestVisible(qvariant_cast<QObjectList>(window->property(Constants::kHitTestVisibleFlag)), globalPos);
+}
+
+bool Utilities::isHitTestVisible(const QObjectList &objects, const QPointF &globalPos)
+{
+    for (auto &&obj : objects) {
         if (!obj || !(obj->isWidgetType() || obj->inherits("QQuickItem"))) {
             continue;
         }
@@ -89,13 +102,163 @@ bool Utilities::isHitTestVisible(const QWindow *window)
         const qreal width = obj->property("width").toReal();
         const qreal height = obj->property("height").toReal();
         const QRectF rect = {originPoint.x(), originPoint.y(), width, height};
-        if (rect.contains(QCursor::pos(window->screen()))) {
+        if (rect.contains(globalPos)) {
             return true;
         }
     }
     return false;
 }
 
+GeometryConstraints Utilities::windowGeometryConstraints(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return {};
+    }
+    GeometryConstraints constraints = {};
+    constraints.minimumSize = window->minimumSize();
+    constraints.maximumSize = window->maximumSize();
+    constraints.sizeIncrement = window->sizeIncrement();
+    constraints.baseSize = window->baseSize();
+    constraints.aspectRatio = window->property(Constants::kAspectRatioFlag).toReal();
+    constraints.workArea = ScreenIndex::availableGeometry(window->screen());
+    return constraints;
+}
+
+// Snaps "value" down to "base + n * increment".
+[[nodiscard]] static inline int snapToIncrement(const int value, const int base, const int increment)
+{
+    if ((increment <= 1) || (value <= base)) {
+        return value;
+    }
+    return (base + (((value - base) / increment) * increment));
+}
+
+// Narrows [minimum, maximum] down to its first and last "base + n * increment"
+// values, so that clamping doesn't undo the snapping. Left alone if there are none.
+static inline void alignRangeToIncrement(int *minimum, int *maximum, const int base, const int increment)
+{
+    Q_ASSERT(minimum);
+    Q_ASSERT(maximum);
+    if (!minimum || !maximum || (increment <= 1) || (*maximum < base)) {
+        return;
+    }
+    const int lower = ((*minimum <= base) ? base : (base + (((*minimum - base + increment - 1) / increment) * increment)));
+    const int upper = snapToIncrement(*maximum, base, increment);
+    if (lower <= upper) {
+        *minimum = lower;
+        *maximum = upper;
+    }
+}
+
+QRect Utilities::calculateResizeGeometry(const QRect &original, const Qt::Edges edges,
+                                         const QPoint &delta, const GeometryConstraints &constraints)
+{
+    if (!original.isValid() || (edges == Qt::Edges{})) {
+        return original;
+    }
+    const bool horizontal = ((edges & Qt::LeftEdge) || (edges & Qt::RightEdge));
+    const bool vertical = ((edges & Qt::TopEdge) || (edges & Qt::BottomEdge));
+    int width = original.width();
+    if (edges & Qt::LeftEdge) {
+        width -= delta.x();
+    } else if (edges & Qt::RightEdge) {
+        width += delta.x();
+    }
+    int height = original.height();
+    if (edges & Qt::TopEdge) {
+        height -= delta.y();
+    } else if (edges & Qt::BottomEdge) {
+        height += delta.y();
+    }
+
+    // The size range, and how far the moving edges may go.
+    const int minWidth = qMax(constraints.minimumSize.width(), 1);
+    const int minHeight = qMax(constraints.minimumSize.height(), 1);
+    int maxWidth = qMax(constraints.maximumSize.width(), minWidth);
+    int maxHeight = qMax(constraints.maximumSize.height(), minHeight);
+    if (constraints.workArea.isValid()) {
+        // A window which is already partly outside of the work area keeps its size at least.
+        if (edges & Qt::LeftEdge) {
+            maxWidth = qMin(maxWidth, qMax(original.right() - constraints.workArea.left() + 1, original.width()));
+        } else if (edges & Qt::RightEdge) {
+            maxWidth = qMin(maxWidth, qMax(constraints.workArea.right() - original.left() + 1, original.width()));
+        }
+        if (edges & Qt::TopEdge) {
+            maxHeight = qMin(maxHeight, qMax(original.bottom() - constraints.workArea.top() + 1, original.height()));
+        } else if (edges & Qt::BottomEdge) {
+            maxHeight = qMin(maxHeight, qMax(constraints.workArea.bottom() - original.top() + 1, original.height()));
+        }
+        maxWidth = qMax(maxWidth, minWidth);
+        maxHeight = qMax(maxHeight, minHeight);
+    }
+
+    // 1. Size increments, for the dimensions which are being dragged.
+    const QSize base = (constraints.baseSize.isValid() ? constraints.baseSize : constraints.minimumSize);
+    int lowerWidth = minWidth;
+    int upperWidth = maxWidth;
+    if (horizontal) {
+        width = snapToIncrement(width, base.width(), constraints.sizeIncrement.width());
+        alignRangeToIncrement(&lowerWidth, &upperWidth, base.width(), constraints.sizeIncrement.width());
+    }
+    int lowerHeight = minHeight;
+    int upperHeight = maxHeight;
+    if (vertical) {
+        height = snapToIncrement(height, base.height(), constraints.sizeIncrement.height());
+        alignRangeToIncrement(&lowerHeight, &upperHeight, base.height(), constraints.sizeIncrement.height());
+    }
+
+    // 2. The aspect ratio: the dimension the user is dragging decides the
+    // other one, for corners the one which grew (or shrank) the most.
+    // 3. The size range, last, so that nothing can push the result out of it
+    // again. With an aspect ratio both ranges are combined into one for the
+    // leading dimension, to keep the ratio.
+    if (constraints.aspectRatio > 0.0) {
+        const qreal ratio = constraints.aspectRatio;
+        bool followWidth = horizontal;
+        if (horizontal && vertical) {
+            followWidth = (qAbs(width - original.width()) >= qAbs(qRound(height * ratio) - original.width()));
+        }
+        if (followWidth) {
+            const int lower = qMax(lowerWidth, qCeil(minHeight * ratio));
+            const int upper = qMax(qMin(upperWidth, qFloor(maxHeight * ratio)), lower);
+            width = qBound(lower, width, upper);
+            height = qRound(width / ratio);
+        } else {
+            const int lower = qMax(lowerHeight, qCeil(minWidth / ratio));
+            const int upper = qMax(qMin(upperHeight, qFloor(maxWidth / ratio)), lower);
+            height = qBound(lower, height, upper);
+            width = qRound(height * ratio);
+        }
+    } else {
+        width = qBound(lowerWidth, width, upperWidth);
+        height = qBound(lowerHeight, height, upperHeight);
+    }
+    // Constraints which contradict each other can't all be met, the size
+    // range always wins.
+    width = qBound(minWidth, width, maxWidth);
+    height = qBound(minHeight, height, maxHeight);
+
+    // The edges opposite to the dragged ones stay where they are.
+    const int x = ((edges & Qt::LeftEdge) ? (original.right() - width + 1) : original.left());
+    const int y = ((edges & Qt::TopEdge) ? (original.bottom() - height + 1) : original.top());
+    return {x, y, width, height};
+}
+
+QRect Utilities::calculateRestoreGeometry(const QRect &maximized, const QSize &restoredSize,
+                                          const QPoint &pressPos, const QPoint &currentPos)
+{
+    if (!maximized.isValid() || !restoredSize.isValid()) {
+        return {};
+    }
+    // The pointer keeps its relative horizontal position over the title bar,
+    // and its distance from the top edge (the title bar doesn't change height).
+    const qreal ratio = qBound(0.0, (qreal(pressPos.x() - maximized.left()) / qreal(maximized.width())), 1.0);
+    const int offsetX = qRound(ratio * restoredSize.width());
+    const int offsetY = qBound(0, (pressPos.y() - maximized.top()), (restoredSize.height() - 1));
+    return {QPoint(currentPos.x() - offsetX, currentPos.y() - offsetY), restoredSize};
+}
+
 QPointF Utilities::mapOriginPointToWindow(const QObject *object)
 {
     Q_ASSERT(object);
@@ -29,6 +29,21 @@
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
+struct GeometryConstraints
+{
+    QSize minimumSize = {};
+    QSize maximumSize = {QWINDOWSIZE_MAX, QWINDOWSIZE_MAX};
+    QSize sizeIncrement = {};
+    // The size the increments are counted from, the minimum size if invalid.
+    QSize baseSize = {};
+    // Width divided by height, ignored if not positive.
+    qreal aspectRatio = 0.0;
+    // The moving edges can't be dragged out of this rect, ignored if invalid.
+    // windowGeometryConstraints() sets it to the work area of the window's
+    // screen (like most window managers, which stop a resize at the panels).
+    QRect workArea = {};
+};
+
 namespace Utilities
 {
 
@@ -36,7 +51,17 @@ namespace Utilities
 [[nodiscard]] FRAMELESSHELPER_API QWindow *findWindow(const WId winId);
 [[nodiscard]] FRAMELESSHELPER_API bool isWindowFixedSize(const QWindow *window);
 [[nodiscard]] FRAMELESSHELPER_API bool isHitTestVisible(const QWindow *window);
+[[nodiscard]] FRAMELESSHELPER_API bool isHitTestVisible(const QWindow *window, const QPointF &globalPos);
+[[nodiscard]] FRAMELESSHELPER_API bool isHitTestVisible(const QObjectList &objects, const QPointF &globalPos);
 [[nodiscard]] FRAMELESSHELPER_API QPointF mapOriginPointToWindow(const QObject *object);
+[[nodiscard]] FRAMELESSHELPER_API GeometryConstraints windowGeometryConstraints(const QWindow *window);
+// The geometry of "original" resized by dragging "edges" by "delta". The size
+// increments are applied first, then the aspect ratio, then the size range
+// (and the work area), which are never exceeded.
+[[nodiscard]] FRAMELESSHELPER_API QRect calculateResizeGeometry(const QRect &original, const Qt::Edges edges,
+                                                               const QPoint &delta, const GeometryConstraints &constraints);
+[[nodiscard]] FRAMELESSHELPER_API QRect calculateRestoreGeometry(const QRect &maximized, const QSize &restoredSize,
+                                                                const QPoint &pressPos, const QPoint &currentPos);
 [[nodiscard]] FRAMELESSHELPER_API QColor getColorizationColor();
 [[nodiscard]] FRAMELESSHELPER_API int getWindowVisibleFrameBorderThickness(const WId winId);
 [[nodiscard]] FRAMELESSHELPER_API bool shouldAppsUseDarkMode();
@@ -57,6 +82,13 @@ FRAMELESSHELPER_API void updateQtFrameMargins(QWindow *window, const bool enable
 [[nodiscard]] FRAMELESSHELPER_API QString getSystemErrorMessage(const QString &function);
 #endif
 
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+// Adds the aspect ratio of the window to its WM_NORMAL_HINTS (Qt already
+// publishes the size increment and the base size, but not the aspect ratio),
+// so that the window manager honours it as well.
+FRAMELESSHELPER_API void updateWindowSizeHints(const QWindow *window);
+#endif
+
 }
 
 FRAMELESSHELPER_END_NAMESPACE
@@ -23,14 +23,40 @@
  */
 
 #include "utilities.h"
+#include "themehelper_linux_p.h"
 
 #include <QtCore/qvariant.h>
+#ifdef FRAMELESSHELPER_HAS_XCB
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qpa/qplatformnativeinterface.h>
+#include <xcb/xcb.h>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#endif
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
 static constexpr int kDefaultResizeBorderThickness = 8;
 static constexpr int kDefaultCaptionHeight = 23;
 
+#ifdef FRAMELESSHELPER_HAS_XCB
+// The WM_SIZE_HINTS layout from the ICCCM (section 4.1.2.3), we don't want
+// to depend on xcb-icccm just for this.
+static constexpr int kSizeHintsLength = 18;
+static constexpr quint32 kSizeHintsAspectFlag = (1 << 7); // PAspect
+enum SizeHintsField : int
+{
+    SizeHintsFlags = 0,
+    SizeHintsMinAspectNum = 11,
+    SizeHintsMinAspectDen = 12,
+    SizeHintsMaxAspectNum = 13,
+    SizeHintsMaxAspectDen = 14
+};
+// The aspect ratio is published as a fraction with this denominator.
+static constexpr qint32 kAspectRatioDenominator = 10000;
+#endif
+
 int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric, const bool dpiScale, const bool forceSystemValue)
 {
     Q_ASSERT(window);
@@ -41,15 +67,17 @@ int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric,
     const qreal scaleFactor = (dpiScale ? devicePixelRatio : 1.0);
     switch (metric) {
     case SystemMetric::ResizeBorderThickness: {
-        const int resizeBorderThickness = window->property(Constants::kResizeBorderThicknessFlag).toInt();
-        if ((resizeBorderThickness > 0) && !forceSystemValue) {
+        const int resizeBorderThickness = (forceSystemValue ? 0 : window->property(Constants::kResizeBorderThicknessFlag).toInt());
+        if (resizeBorderThickness > 0) {
             return qRound(static_cast<qreal>(resizeBorderThickness) * scaleFactor);
         } else {
-            // ### TO BE IMPLEMENTED: Retrieve system value through official API
+            // Filled in by the background probe, the default value is used until it has finished.
+            const int systemValue = ThemeHelperLinux::snapshot().resizeBorderThickness;
+            const int value = ((systemValue > 0) ? systemValue : kDefaultResizeBorderThickness);
             if (dpiScale) {
-                return qRound(static_cast<qreal>(kDefaultResizeBorderThickness) * devicePixelRatio);
+                return qRound(static_cast<qreal>(value) * devicePixelRatio);
             } else {
-                return kDefaultResizeBorderThickness;
+                return value;
             }
         }
     }
@@ -86,7 +114,10 @@ int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric,
 
 QColor Utilities::getColorizationColor()
 {
-    // ### TO BE IMPLEMENTED
+    const ThemeHelperLinux::Snapshot snapshot = ThemeHelperLinux::snapshot();
+    if (snapshot.hasAccentColor) {
+        return QColor::fromRgba(snapshot.accentColor);
+    }
     return Qt::darkGray;
 }
 
@@ -99,21 +130,21 @@ int Utilities::getWindowVisibleFrameBorderThickness(const WId winId)
 
 bool Utilities::shouldAppsUseDarkMode()
 {
-    // ### TO BE IMPLEMENTED
-    return false;
+    const ThemeHelperLinux::Snapshot snapshot = ThemeHelperLinux::snapshot();
+    return (snapshot.hasColorScheme && snapshot.dark);
 }
 
 ColorizationArea Utilities::getColorizationArea()
 {
-    // ### TO BE IMPLEMENTED
-    return ColorizationArea::None;
+    // The accent color published by the desktop portal is a desktop wide
+    // setting, there's no separate switch for the title bars.
+    const ThemeHelperLinux::Snapshot snapshot = ThemeHelperLinux::snapshot();
+    return (snapshot.hasAccentColor ? ColorizationArea::All : ColorizationArea::None);
 }
 
 bool Utilities::isThemeChanged(const void *data)
 {
-    // ### TO BE IMPLEMENTED
-    Q_UNUSED(data);
-    return false;
+    return ThemeHelperLinux::isThemeChangedEvent(data);
 }
 
 bool Utilities::isSystemMenuRequested(const void *data, QPointF *pos)
@@ -132,4 +163,61 @@ bool Utilities::showSystemMenu(const WId winId, const QPointF &pos)
     return false;
 }
 
+void Utilities::updateWindowSizeHints(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+#ifdef FRAMELESSHELPER_HAS_XCB
+    if (!window->handle() || (QGuiApplication::platformName() != QStringLiteral("xcb"))) {
+        return;
+    }
+    // Qt never publishes an aspect ratio itself, without one there's nothing
+    // to add to (or remove from) the property.
+    const QVariant aspectRatioValue = window->property(Constants::kAspectRatioFlag);
+    if (!aspectRatioValue.isValid()) {
+        return;
+    }
+    const qreal aspectRatio = aspectRatioValue.toReal();
+    const auto connection = static_cast<xcb_connection_t *>(QGuiApplication::platformNativeInterface()
+                                ->nativeResourceForIntegration(QByteArrayLiteral("connection")));
+    if (!connection) {
+        return;
+    }
+    const auto winId = static_cast<xcb_window_t>(window->winId());
+    // Qt owns WM_NORMAL_HINTS (and rewrites it whenever the geometry or the
+    // size limits change). It fills in everything but the aspect ratio, so the
+    // current property is read back and only the aspect ratio fields are
+    // changed, the position, the size and the size limits are kept as they are.
+    std::array<quint32, kSizeHintsLength> hints = {};
+    const xcb_get_property_cookie_t cookie = xcb_get_property(connection, false, winId,
+        XCB_ATOM_WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 0, kSizeHintsLength);
+    if (xcb_get_property_reply_t * const reply = xcb_get_property_reply(connection, cookie, nullptr)) {
+        if ((reply->type == XCB_ATOM_WM_SIZE_HINTS) && (reply->format == 32)) {
+            const int length = qMin(xcb_get_property_value_length(reply) / 4, kSizeHintsLength);
+            std::memcpy(hints.data(), xcb_get_property_value(reply), (length * 4));
+        }
+        std::free(reply);
+    }
+    const std::array<quint32, kSizeHintsLength> originalHints = hints;
+    if (aspectRatio > 0.0) {
+        const auto numerator = static_cast<quint32>(qRound(aspectRatio * kAspectRatioDenominator));
+        hints[SizeHintsFlags] |= kSizeHintsAspectFlag;
+        hints[SizeHintsMinAspectNum] = numerator;
+        hints[SizeHintsMinAspectDen] = kAspectRatioDenominator;
+        hints[SizeHintsMaxAspectNum] = numerator;
+        hints[SizeHintsMaxAspectDen] = kAspectRatioDenominator;
+    } else {
+        hints[SizeHintsFlags] &= ~kSizeHintsAspectFlag;
+    }
+    if (hints == originalHints) {
+        return;
+    }
+    xcb_change_property(connection, XCB_PROP_MODE_REPLACE, winId, XCB_ATOM_WM_NORMAL_HINTS,
+                        XCB_ATOM_WM_SIZE_HINTS, 32, kSizeHintsLength, hints.data());
+    xcb_flush(connection);
+#endif
+}
+
 FRAMELESSHELPER_END_NAMESPACE
\ No newline at end of file